@@ -0,0 +1,213 @@
+/*
+ MIT License
+
+ Copyright (c) 2024 Mayur Pawashe
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+// Times classifyCubeCollisions against a plain scalar loop over the same cube field and checks they agree
+// Build from src/ with "make collisionbench", or with:
+//   cc -O2 -Iscengine collisionbench.c cube_collision.c -lm -o collisionbench
+// Usage:
+//   collisionbench [--rounds N] [--seed S]
+// Each round classifies a field of CUBE_COUNT cubes with the player at a different depth
+
+#include "cube_collision.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define DEFAULT_ROUND_COUNT 20000
+#define FIELD_DEPTH 2000.0f
+
+// The same field and player dimensions the game uses
+#define CUBE_COUNT 4096
+#define CUBE_MAGNITUDE 1.0f
+#define PLAYER_MAGNITUDE 0.05f
+#define MAX_BOUNDARY_X_MAGNITUDE 8
+#define CUBE_PLAYER_WARN_MAX_FACTOR 8
+
+static double currentWallTime(void)
+{
+    struct timespec timeSpec;
+    timespec_get(&timeSpec, TIME_UTC);
+    return (double)timeSpec.tv_sec + (double)timeSpec.tv_nsec / 1e9;
+}
+
+// One cube at a time, the way collisions were classified before the kernel existed
+static void classifyCubeCollisionsScalar(const ZGFloat *xs, const ZGFloat *ys, const ZGFloat *zs, uint32_t cubeCount, ZGFloat playerX, ZGFloat playerY, ZGFloat playerZ, ZGFloat collisionDistance, ZGFloat warningDistance, ZGFloat passedDepth, uint8_t *results)
+{
+    ZGFloat collisionDistanceSquared = collisionDistance * collisionDistance;
+    ZGFloat warningDistanceSquared = warningDistance * warningDistance;
+    for (uint32_t cubeIndex = 0; cubeIndex < cubeCount; cubeIndex++)
+    {
+        ZGFloat dx = xs[cubeIndex] - playerX;
+        ZGFloat dy = ys[cubeIndex] - playerY;
+        ZGFloat dz = zs[cubeIndex] - playerZ;
+        ZGFloat distanceSquared = dx * dx + dy * dy + dz * dz;
+        
+        uint8_t result = 0;
+        if (distanceSquared <= collisionDistanceSquared)
+        {
+            result |= CUBE_COLLISION_RESULT_HIT;
+        }
+        if (zs[cubeIndex] > passedDepth)
+        {
+            result |= CUBE_COLLISION_RESULT_PASSED;
+        }
+        if (distanceSquared <= warningDistanceSquared)
+        {
+            result |= CUBE_COLLISION_RESULT_IN_WARNING_RANGE;
+        }
+        results[cubeIndex] = result;
+    }
+}
+
+// Xorshift is plenty for scattering cubes, and keeps the field the same on every platform
+static uint32_t nextFieldRandom(uint32_t *state)
+{
+    uint32_t value = *state;
+    value ^= value << 13;
+    value ^= value >> 17;
+    value ^= value << 5;
+    *state = value;
+    return value;
+}
+
+static ZGFloat playerDepthForRound(uint32_t round, uint32_t roundCount)
+{
+    return -FIELD_DEPTH * (ZGFloat)round / (ZGFloat)roundCount;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t roundCount = DEFAULT_ROUND_COUNT;
+    uint32_t seed = 1;
+    
+    for (int argumentIndex = 1; argumentIndex < argc; argumentIndex++)
+    {
+        const char *argument = argv[argumentIndex];
+        if (strcmp(argument, "--rounds") == 0 && argumentIndex + 1 < argc)
+        {
+            roundCount = (uint32_t)strtoul(argv[++argumentIndex], NULL, 10);
+        }
+        else if (strcmp(argument, "--seed") == 0 && argumentIndex + 1 < argc)
+        {
+            seed = (uint32_t)strtoul(argv[++argumentIndex], NULL, 10);
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [--rounds N] [--seed S]\n", argv[0]);
+            return 1;
+        }
+    }
+    
+    if (roundCount == 0)
+    {
+        fprintf(stderr, "Error: --rounds must be at least 1\n");
+        return 1;
+    }
+    
+    // Cubes sit on the same grid the game places them on, spread through the field's depth
+    static ZGFloat xs[CUBE_COUNT];
+    static ZGFloat ys[CUBE_COUNT];
+    static ZGFloat zs[CUBE_COUNT];
+    uint32_t randomState = (seed != 0) ? seed : 1;
+    const uint32_t columnCount = (uint32_t)((MAX_BOUNDARY_X_MAGNITUDE * 2.0f) / (CUBE_MAGNITUDE * 2.0f));
+    for (uint32_t cubeIndex = 0; cubeIndex < CUBE_COUNT; cubeIndex++)
+    {
+        xs[cubeIndex] = (ZGFloat)(-MAX_BOUNDARY_X_MAGNITUDE + CUBE_MAGNITUDE) + (ZGFloat)(nextFieldRandom(&randomState) % columnCount) * (CUBE_MAGNITUDE * 2);
+        ys[cubeIndex] = 0.0f;
+        zs[cubeIndex] = -FIELD_DEPTH * (ZGFloat)cubeIndex / CUBE_COUNT;
+    }
+    
+    ZGFloat playerDiagonalDistance = sqrtf((PLAYER_MAGNITUDE * PLAYER_MAGNITUDE) + (PLAYER_MAGNITUDE * PLAYER_MAGNITUDE));
+    ZGFloat cubeDiagonalDistance = sqrtf((CUBE_MAGNITUDE * CUBE_MAGNITUDE) + (CUBE_MAGNITUDE * CUBE_MAGNITUDE));
+    ZGFloat collisionDistance = playerDiagonalDistance + cubeDiagonalDistance;
+    ZGFloat warningDistance = collisionDistance * CUBE_PLAYER_WARN_MAX_FACTOR;
+    
+    static uint8_t scalarResults[CUBE_COUNT];
+    static uint8_t kernelResults[CUBE_COUNT];
+    
+    // Check every round first so the timed loops below only measure classification
+    uint64_t classifiedCounts[3] = {0};
+    for (uint32_t round = 0; round < roundCount; round++)
+    {
+        ZGFloat playerX = (ZGFloat)((int32_t)(round % 17) - 8);
+        ZGFloat playerZ = playerDepthForRound(round, roundCount);
+        ZGFloat passedDepth = playerZ - PLAYER_MAGNITUDE - CUBE_MAGNITUDE;
+        
+        classifyCubeCollisionsScalar(xs, ys, zs, CUBE_COUNT, playerX, 0.0f, playerZ, collisionDistance, warningDistance, passedDepth, scalarResults);
+        classifyCubeCollisions(xs, ys, zs, 0, CUBE_COUNT, playerX, 0.0f, playerZ, collisionDistance, warningDistance, passedDepth, kernelResults);
+        
+        for (uint32_t cubeIndex = 0; cubeIndex < CUBE_COUNT; cubeIndex++)
+        {
+            if (scalarResults[cubeIndex] != kernelResults[cubeIndex])
+            {
+                fprintf(stderr, "Error: round %u cube %u classified as 0x%x by the kernel but 0x%x by the scalar loop\n", round, cubeIndex, kernelResults[cubeIndex], scalarResults[cubeIndex]);
+                return 1;
+            }
+            
+            uint8_t result = kernelResults[cubeIndex];
+            classifiedCounts[0] += (result & CUBE_COLLISION_RESULT_HIT) != 0;
+            classifiedCounts[1] += (result & CUBE_COLLISION_RESULT_PASSED) != 0;
+            classifiedCounts[2] += (result & CUBE_COLLISION_RESULT_IN_WARNING_RANGE) != 0;
+        }
+    }
+    
+    // Fold results into a checksum so neither loop can be optimized away
+    uint32_t scalarChecksum = 0;
+    double scalarStartTime = currentWallTime();
+    for (uint32_t round = 0; round < roundCount; round++)
+    {
+        ZGFloat playerZ = playerDepthForRound(round, roundCount);
+        classifyCubeCollisionsScalar(xs, ys, zs, CUBE_COUNT, (ZGFloat)((int32_t)(round % 17) - 8), 0.0f, playerZ, collisionDistance, warningDistance, playerZ - PLAYER_MAGNITUDE - CUBE_MAGNITUDE, scalarResults);
+        scalarChecksum += scalarResults[round % CUBE_COUNT];
+    }
+    double scalarElapsedTime = currentWallTime() - scalarStartTime;
+    
+    uint32_t kernelChecksum = 0;
+    double kernelStartTime = currentWallTime();
+    for (uint32_t round = 0; round < roundCount; round++)
+    {
+        ZGFloat playerZ = playerDepthForRound(round, roundCount);
+        classifyCubeCollisions(xs, ys, zs, 0, CUBE_COUNT, (ZGFloat)((int32_t)(round % 17) - 8), 0.0f, playerZ, collisionDistance, warningDistance, playerZ - PLAYER_MAGNITUDE - CUBE_MAGNITUDE, kernelResults);
+        kernelChecksum += kernelResults[round % CUBE_COUNT];
+    }
+    double kernelElapsedTime = currentWallTime() - kernelStartTime;
+    
+    if (scalarChecksum != kernelChecksum)
+    {
+        fprintf(stderr, "Error: timed runs disagree (checksums %u and %u)\n", scalarChecksum, kernelChecksum);
+        return 1;
+    }
+    
+    double cubeCount = (double)roundCount * CUBE_COUNT;
+    printf("rounds: %u of %u cubes\n", roundCount, CUBE_COUNT);
+    printf("results agree: %llu hits, %llu passed, %llu in warning range\n", (unsigned long long)classifiedCounts[0], (unsigned long long)classifiedCounts[1], (unsigned long long)classifiedCounts[2]);
+    printf("scalar: %.3f s, %.2f ns/cube\n", scalarElapsedTime, scalarElapsedTime * 1e9 / cubeCount);
+    printf("kernel: %.3f s, %.2f ns/cube\n", kernelElapsedTime, kernelElapsedTime * 1e9 / cubeCount);
+    printf("speedup: %.2fx\n", (kernelElapsedTime > 0.0) ? scalarElapsedTime / kernelElapsedTime : 0.0);
+    
+    return 0;
+}
@@ -0,0 +1,132 @@
+/*
+ MIT License
+
+ Copyright (c) 2024 Mayur Pawashe
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#include "cube_collision.h"
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CUBE_COLLISION_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define CUBE_COLLISION_NEON 1
+#include <arm_neon.h>
+#endif
+
+static uint8_t classifyCubeCollision(ZGFloat x, ZGFloat y, ZGFloat z, ZGFloat playerX, ZGFloat playerY, ZGFloat playerZ, ZGFloat collisionDistanceSquared, ZGFloat warningDistanceSquared, ZGFloat passedDepth)
+{
+    ZGFloat dx = x - playerX;
+    ZGFloat dy = y - playerY;
+    ZGFloat dz = z - playerZ;
+    ZGFloat distanceSquared = dx * dx + dy * dy + dz * dz;
+    
+    uint8_t result = 0;
+    if (distanceSquared <= collisionDistanceSquared)
+    {
+        result |= CUBE_COLLISION_RESULT_HIT;
+    }
+    if (z > passedDepth)
+    {
+        result |= CUBE_COLLISION_RESULT_PASSED;
+    }
+    if (distanceSquared <= warningDistanceSquared)
+    {
+        result |= CUBE_COLLISION_RESULT_IN_WARNING_RANGE;
+    }
+    return result;
+}
+
+void classifyCubeCollisions(const ZGFloat *xs, const ZGFloat *ys, const ZGFloat *zs, uint32_t startIndex, uint32_t endIndex, ZGFloat playerX, ZGFloat playerY, ZGFloat playerZ, ZGFloat collisionDistance, ZGFloat warningDistance, ZGFloat passedDepth, uint8_t *results)
+{
+    ZGFloat collisionDistanceSquared = collisionDistance * collisionDistance;
+    ZGFloat warningDistanceSquared = warningDistance * warningDistance;
+    
+    uint32_t cubeIndex = startIndex;
+    
+#if CUBE_COLLISION_SSE2
+    __m128 playerXs = _mm_set1_ps(playerX);
+    __m128 playerYs = _mm_set1_ps(playerY);
+    __m128 playerZs = _mm_set1_ps(playerZ);
+    __m128 collisionDistancesSquared = _mm_set1_ps(collisionDistanceSquared);
+    __m128 warningDistancesSquared = _mm_set1_ps(warningDistanceSquared);
+    __m128 passedDepths = _mm_set1_ps(passedDepth);
+    
+    __m128i hitResults = _mm_set1_epi32(CUBE_COLLISION_RESULT_HIT);
+    __m128i passedResults = _mm_set1_epi32(CUBE_COLLISION_RESULT_PASSED);
+    __m128i warningResults = _mm_set1_epi32(CUBE_COLLISION_RESULT_IN_WARNING_RANGE);
+    
+    for (; cubeIndex + 4 <= endIndex; cubeIndex += 4)
+    {
+        __m128 cubeZs = _mm_loadu_ps(&zs[cubeIndex]);
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(&xs[cubeIndex]), playerXs);
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(&ys[cubeIndex]), playerYs);
+        __m128 dz = _mm_sub_ps(cubeZs, playerZs);
+        __m128 distancesSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        
+        __m128i laneResults = _mm_and_si128(_mm_castps_si128(_mm_cmple_ps(distancesSquared, collisionDistancesSquared)), hitResults);
+        laneResults = _mm_or_si128(laneResults, _mm_and_si128(_mm_castps_si128(_mm_cmpgt_ps(cubeZs, passedDepths)), passedResults));
+        laneResults = _mm_or_si128(laneResults, _mm_and_si128(_mm_castps_si128(_mm_cmple_ps(distancesSquared, warningDistancesSquared)), warningResults));
+        
+        // Narrow each lane down to a byte and store all four at once
+        __m128i packedResults = _mm_packus_epi16(_mm_packs_epi32(laneResults, laneResults), laneResults);
+        int32_t resultBytes = _mm_cvtsi128_si32(packedResults);
+        memcpy(&results[cubeIndex], &resultBytes, sizeof(resultBytes));
+    }
+#elif CUBE_COLLISION_NEON
+    float32x4_t playerXs = vdupq_n_f32(playerX);
+    float32x4_t playerYs = vdupq_n_f32(playerY);
+    float32x4_t playerZs = vdupq_n_f32(playerZ);
+    float32x4_t collisionDistancesSquared = vdupq_n_f32(collisionDistanceSquared);
+    float32x4_t warningDistancesSquared = vdupq_n_f32(warningDistanceSquared);
+    float32x4_t passedDepths = vdupq_n_f32(passedDepth);
+    
+    uint32x4_t hitResults = vdupq_n_u32(CUBE_COLLISION_RESULT_HIT);
+    uint32x4_t passedResults = vdupq_n_u32(CUBE_COLLISION_RESULT_PASSED);
+    uint32x4_t warningResults = vdupq_n_u32(CUBE_COLLISION_RESULT_IN_WARNING_RANGE);
+    
+    for (; cubeIndex + 4 <= endIndex; cubeIndex += 4)
+    {
+        float32x4_t cubeZs = vld1q_f32(&zs[cubeIndex]);
+        float32x4_t dx = vsubq_f32(vld1q_f32(&xs[cubeIndex]), playerXs);
+        float32x4_t dy = vsubq_f32(vld1q_f32(&ys[cubeIndex]), playerYs);
+        float32x4_t dz = vsubq_f32(cubeZs, playerZs);
+        float32x4_t distancesSquared = vaddq_f32(vaddq_f32(vmulq_f32(dx, dx), vmulq_f32(dy, dy)), vmulq_f32(dz, dz));
+        
+        uint32x4_t laneResults = vandq_u32(vcleq_f32(distancesSquared, collisionDistancesSquared), hitResults);
+        laneResults = vorrq_u32(laneResults, vandq_u32(vcgtq_f32(cubeZs, passedDepths), passedResults));
+        laneResults = vorrq_u32(laneResults, vandq_u32(vcleq_f32(distancesSquared, warningDistancesSquared), warningResults));
+        
+        // Narrow each lane down to a byte and store all four at once
+        uint16x4_t narrowedResults = vmovn_u32(laneResults);
+        uint8x8_t packedResults = vmovn_u16(vcombine_u16(narrowedResults, narrowedResults));
+        uint32_t resultBytes = vget_lane_u32(vreinterpret_u32_u8(packedResults), 0);
+        memcpy(&results[cubeIndex], &resultBytes, sizeof(resultBytes));
+    }
+#endif
+    
+    for (; cubeIndex < endIndex; cubeIndex++)
+    {
+        results[cubeIndex] = classifyCubeCollision(xs[cubeIndex], ys[cubeIndex], zs[cubeIndex], playerX, playerY, playerZ, collisionDistanceSquared, warningDistanceSquared, passedDepth);
+    }
+}
@@ -0,0 +1,36 @@
+/*
+ MIT License
+
+ Copyright (c) 2024 Mayur Pawashe
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#pragma once
+
+#include "float.h"
+#include <stdint.h>
+
+#define CUBE_COLLISION_RESULT_HIT 0x1
+#define CUBE_COLLISION_RESULT_PASSED 0x2
+#define CUBE_COLLISION_RESULT_IN_WARNING_RANGE 0x4
+
+// Classifies cubes in [startIndex, endIndex) against the player, writing a mask of CUBE_COLLISION_RESULT_* values for each cube to results[cubeIndex]
+// Distances are compared squared, and a cube has been passed once its depth is greater than passedDepth
+void classifyCubeCollisions(const ZGFloat *xs, const ZGFloat *ys, const ZGFloat *zs, uint32_t startIndex, uint32_t endIndex, ZGFloat playerX, ZGFloat playerY, ZGFloat playerZ, ZGFloat collisionDistance, ZGFloat warningDistance, ZGFloat passedDepth, uint8_t *results);
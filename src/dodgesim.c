@@ -0,0 +1,365 @@
+/*
+ MIT License
+
+ Copyright (c) 2024 Mayur Pawashe
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+// Runs the game simulation headlessly for balancing and regression checks
+// Build from src/ with "make dodgesim", or with:
+//   cc -O2 -Iscengine dodgesim.c simulation.c cube_collision.c replay.c scengine/mt_random.c -lm -o dodgesim
+// Usage:
+//   dodgesim [--ticks N] [--seed S] [--script PATTERN] [--record PATH] [--endless] [--tick-rate HZ]
+//   dodgesim --replay PATH
+// Without a script the player steers randomly. A script is a comma separated list of
+// steering commands and tick counts that repeats, e.g. "l30,n10,r30,b5" where
+// l = left, r = right, n = none and b = both
+// --record saves the first game as a replay and prints how it ended, and --replay re-simulates a replay as fast as possible
+// --endless plays the streaming endless mode instead of classic fields
+// --tick-rate steps the simulation 60, 120, 240 or 480 times per second; tick counts stay in ticks
+
+#include "simulation.h"
+#include "replay.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct
+{
+    SimulationInput input;
+    uint32_t tickCount;
+} ScriptCommand;
+
+#define MAX_SCRIPT_COMMAND_COUNT 256
+
+static uint32_t parseScript(const char *script, ScriptCommand *commands)
+{
+    uint32_t commandCount = 0;
+    const char *scriptPointer = script;
+    while (*scriptPointer != '\0' && commandCount < MAX_SCRIPT_COMMAND_COUNT)
+    {
+        ScriptCommand *command = &commands[commandCount];
+        switch (*scriptPointer)
+        {
+            case 'l':
+                command->input.left = true;
+                command->input.right = false;
+                break;
+            case 'r':
+                command->input.left = false;
+                command->input.right = true;
+                break;
+            case 'n':
+                command->input.left = false;
+                command->input.right = false;
+                break;
+            case 'b':
+                command->input.left = true;
+                command->input.right = true;
+                break;
+            default:
+                fprintf(stderr, "Error: unknown script command '%c'\n", *scriptPointer);
+                exit(EXIT_FAILURE);
+        }
+        
+        char *tickCountEnd = NULL;
+        unsigned long tickCount = strtoul(scriptPointer + 1, &tickCountEnd, 10);
+        if (tickCountEnd == scriptPointer + 1 || tickCount == 0)
+        {
+            fprintf(stderr, "Error: script command '%c' needs a tick count\n", *scriptPointer);
+            exit(EXIT_FAILURE);
+        }
+        
+        command->tickCount = (uint32_t)tickCount;
+        commandCount++;
+        
+        scriptPointer = tickCountEnd;
+        if (*scriptPointer == ',')
+        {
+            scriptPointer++;
+        }
+    }
+    
+    if (commandCount == 0)
+    {
+        fprintf(stderr, "Error: script is empty\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    return commandCount;
+}
+
+// Kept separate from the simulation's random number generator so input doesn't perturb cube generation
+static uint32_t nextInputRandom(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static double currentWallTime(void)
+{
+    struct timespec timeSpec;
+    timespec_get(&timeSpec, TIME_UTC);
+    return (double)timeSpec.tv_sec + (double)timeSpec.tv_nsec / 1e9;
+}
+
+static int runReplay(const char *path)
+{
+    ReplayPlayer *player = loadReplay(path);
+    if (player == NULL)
+    {
+        return EXIT_FAILURE;
+    }
+    
+    uint16_t tickRate = replayTickRate(player);
+    if (!isSupportedSimulationTickRate(tickRate))
+    {
+        fprintf(stderr, "Error: replay %s has an unsupported tick rate of %u\n", path, tickRate);
+        destroyReplayPlayer(player);
+        return EXIT_FAILURE;
+    }
+    double tickInterval = simulationTickInterval(tickRate);
+    
+    SimulationMode mode = (replayGameMode(player) == SIMULATION_MODE_ENDLESS) ? SIMULATION_MODE_ENDLESS : SIMULATION_MODE_CLASSIC;
+    Simulation *simulation = createSimulation(mode, replaySeed(player));
+    
+    uint64_t tickCount = 0;
+    uint64_t pausedTickCount = 0;
+    
+    double startTime = currentWallTime();
+    
+    uint8_t inputState;
+    ReplayInputChange replayChanges[REPLAY_MAX_TICK_INPUT_CHANGES];
+    uint32_t changeCount;
+    while (nextReplayTickWithInputChanges(player, &inputState, replayChanges, &changeCount))
+    {
+        tickCount++;
+        
+        // Paused ticks still count towards the replay's timeline but don't advance the game
+        if ((inputState & REPLAY_INPUT_PAUSED) != 0)
+        {
+            pausedTickCount++;
+            continue;
+        }
+        
+        SimulationInput input;
+        input.left = (inputState & REPLAY_INPUT_LEFT) != 0;
+        input.right = (inputState & REPLAY_INPUT_RIGHT) != 0;
+        
+        SimulationInputChange changes[REPLAY_MAX_TICK_INPUT_CHANGES];
+        for (uint32_t changeIndex = 0; changeIndex < changeCount; changeIndex++)
+        {
+            changes[changeIndex].input.left = (replayChanges[changeIndex].inputState & REPLAY_INPUT_LEFT) != 0;
+            changes[changeIndex].input.right = (replayChanges[changeIndex].inputState & REPLAY_INPUT_RIGHT) != 0;
+            changes[changeIndex].stepFraction = (double)replayChanges[changeIndex].subdivision / REPLAY_TICK_SUBDIVISIONS;
+        }
+        
+        stepSimulationWithInputChanges(simulation, input, changes, changeCount, tickInterval);
+    }
+    
+    double elapsedTime = currentWallTime() - startTime;
+    
+    SimulationObservation observation = observeSimulation(simulation);
+    
+    printf("mode: %s\n", (mode == SIMULATION_MODE_ENDLESS) ? "endless" : "classic");
+    printf("seed: %u\n", replaySeed(player));
+    printf("tick rate: %u\n", tickRate);
+    printf("ticks: %llu (%llu paused)\n", (unsigned long long)tickCount, (unsigned long long)pausedTickCount);
+    printf("score: %u\n", observation.score);
+    printf("player lost: %s\n", observation.playerLost ? "yes" : "no");
+    printf("elapsed: %.3f s\n", elapsedTime);
+    
+    destroySimulation(simulation);
+    destroyReplayPlayer(player);
+    
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[])
+{
+    uint64_t tickCount = 1000000;
+    uint32_t seed = 1;
+    const char *script = NULL;
+    const char *recordPath = NULL;
+    SimulationMode mode = SIMULATION_MODE_CLASSIC;
+    uint32_t tickRate = SIMULATION_DEFAULT_TICK_RATE;
+    
+    for (int argumentIndex = 1; argumentIndex < argc; argumentIndex++)
+    {
+        const char *argument = argv[argumentIndex];
+        const char *value = (argumentIndex + 1 < argc) ? argv[argumentIndex + 1] : NULL;
+        
+        if (strcmp(argument, "--ticks") == 0 && value != NULL)
+        {
+            tickCount = strtoull(value, NULL, 10);
+            argumentIndex++;
+        }
+        else if (strcmp(argument, "--seed") == 0 && value != NULL)
+        {
+            seed = (uint32_t)strtoul(value, NULL, 10);
+            argumentIndex++;
+        }
+        else if (strcmp(argument, "--script") == 0 && value != NULL)
+        {
+            script = value;
+            argumentIndex++;
+        }
+        else if (strcmp(argument, "--record") == 0 && value != NULL)
+        {
+            recordPath = value;
+            argumentIndex++;
+        }
+        else if (strcmp(argument, "--endless") == 0)
+        {
+            mode = SIMULATION_MODE_ENDLESS;
+        }
+        else if (strcmp(argument, "--tick-rate") == 0 && value != NULL && isSupportedSimulationTickRate((uint32_t)strtoul(value, NULL, 10)))
+        {
+            tickRate = (uint32_t)strtoul(value, NULL, 10);
+            argumentIndex++;
+        }
+        else if (strcmp(argument, "--replay") == 0 && value != NULL)
+        {
+            return runReplay(value);
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [--ticks N] [--seed S] [--script PATTERN] [--record PATH] [--endless] [--tick-rate 60|120|240|480]\n       %s --replay PATH\n", argv[0], argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    
+    ScriptCommand scriptCommands[MAX_SCRIPT_COMMAND_COUNT];
+    uint32_t scriptCommandCount = (script != NULL) ? parseScript(script, scriptCommands) : 0;
+    uint32_t scriptCommandIndex = 0;
+    uint32_t scriptCommandTicksLeft = (scriptCommandCount > 0) ? scriptCommands[0].tickCount : 0;
+    
+    uint32_t inputRandomState = (seed != 0) ? seed : 1;
+    SimulationInput input = {false, false};
+    
+    double tickInterval = simulationTickInterval(tickRate);
+    
+    uint32_t gameSeed = seed;
+    Simulation *simulation = createSimulation(mode, gameSeed);
+    
+    ReplayRecorder *recorder = (recordPath != NULL) ? createReplayRecorder((uint8_t)mode, gameSeed, (uint16_t)tickRate) : NULL;
+    // How the recorded game went, which --replay has to reproduce
+    uint64_t recordedTickCount = 0;
+    uint32_t recordedScore = 0;
+    bool recordedPlayerLost = false;
+    
+    uint64_t gamesFinished = 0;
+    uint64_t totalScore = 0;
+    uint32_t bestScore = 0;
+    
+    double startTime = currentWallTime();
+    
+    for (uint64_t tickIndex = 0; tickIndex < tickCount; tickIndex++)
+    {
+        if (scriptCommandCount > 0)
+        {
+            if (scriptCommandTicksLeft == 0)
+            {
+                scriptCommandIndex = (scriptCommandIndex + 1) % scriptCommandCount;
+                scriptCommandTicksLeft = scriptCommands[scriptCommandIndex].tickCount;
+            }
+            
+            input = scriptCommands[scriptCommandIndex].input;
+            scriptCommandTicksLeft--;
+        }
+        else if (nextInputRandom(&inputRandomState) % 16 == 0)
+        {
+            // Hold each random direction for a while like a player would
+            uint32_t choice = nextInputRandom(&inputRandomState) % 3;
+            input.left = (choice == 0);
+            input.right = (choice == 1);
+        }
+        
+        if (recorder != NULL)
+        {
+            recordReplayTick(recorder, (uint8_t)((input.left ? REPLAY_INPUT_LEFT : 0) | (input.right ? REPLAY_INPUT_RIGHT : 0)));
+            recordedTickCount++;
+        }
+        
+        stepSimulation(simulation, input, tickInterval);
+        
+        SimulationObservation observation = observeSimulation(simulation);
+        if (observation.playerLost)
+        {
+            if (recorder != NULL)
+            {
+                writeReplay(recorder, recordPath);
+                destroyReplayRecorder(recorder);
+                recorder = NULL;
+                
+                recordedScore = observation.score;
+                recordedPlayerLost = true;
+            }
+            
+            gamesFinished++;
+            totalScore += observation.score;
+            if (observation.score > bestScore)
+            {
+                bestScore = observation.score;
+            }
+            
+            gameSeed++;
+            seedSimulation(simulation, gameSeed);
+        }
+    }
+    
+    double elapsedTime = currentWallTime() - startTime;
+    
+    SimulationObservation observation = observeSimulation(simulation);
+    
+    if (recorder != NULL)
+    {
+        writeReplay(recorder, recordPath);
+        destroyReplayRecorder(recorder);
+        
+        recordedScore = observation.score;
+    }
+    
+    printf("ticks: %llu\n", (unsigned long long)tickCount);
+    printf("games finished: %llu\n", (unsigned long long)gamesFinished);
+    printf("average score: %.2f\n", (gamesFinished > 0) ? (double)totalScore / (double)gamesFinished : 0.0);
+    printf("best score: %u\n", bestScore);
+    printf("current game score: %u\n", observation.score);
+    printf("elapsed: %.3f s\n", elapsedTime);
+    printf("ticks/sec: %.0f\n", (elapsedTime > 0.0) ? (double)tickCount / elapsedTime : 0.0);
+    
+    // Printed the same way --replay prints its result so the two can be compared
+    if (recordPath != NULL)
+    {
+        printf("recorded ticks: %llu (0 paused)\n", (unsigned long long)recordedTickCount);
+        printf("recorded score: %u\n", recordedScore);
+        printf("recorded player lost: %s\n", recordedPlayerLost ? "yes" : "no");
+    }
+    
+    destroySimulation(simulation);
+    
+    return EXIT_SUCCESS;
+}
@@ -35,22 +35,29 @@
 #include "renderer_projection.h"
 #include "gamepad.h"
 #include "defaults.h"
+#include "simulation.h"
+#include "replay.h"
+#include "launch_profile.h"
+#include "frame_pacer.h"
+#include "triple_buffer.h"
+#include "job_system.h"
+#include "ring_queue.h"
 
 #include <string.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <time.h>
 
 #define MATH_3D_IMPLEMENTATION
 #include "math_3d.h"
 
 #define MAX_FPS_RATE 120
-#define ANIMATION_TIMER_INTERVAL 0.01666 // in seconds
-#define MAX_ITERATIONS (25 * ANIMATION_TIMER_INTERVAL)
 
 #define FONT_SYSTEM_NAME "Times New Roman"
 #define FONT_POINT_SIZE 144
 
-#define TEXT_RENDERING_CACHE_COUNT 32
+// Changing strings like the score are evicted to stay within this budget
+#define TEXT_RENDERING_CACHE_BYTE_BUDGET (16 * 1024 * 1024)
 
 #if PLATFORM_OSX
 #define WINDOW_TITLE ""
@@ -58,42 +65,97 @@
 #define WINDOW_TITLE "Dodge Danger"
 #endif
 
-#define MAX_CUBE_COUNT 4096
-#define MAX_BOUNDARY_X_MAGNITUDE 8
+// Plenty for the input the player can produce between two steps
+#define MAX_INPUT_TRANSITION_COUNT 256
+
 #define MAX_BOUNDARY_RENDER_GAP 0.2
-#define PLAYER_MAGNITUDE 0.05f
-#define CUBE_MAGNITUDE 1.0f
-#define PLAYER_INITIAL_SPEED 4.0f
-#define PLAYER_SPEED_CAP 20.0f
-#define PLAYER_SPEED_INCREASE 0.2f
-#define CUBE_PLAYER_DIST_AWAY 100.0f
 #define CUBE_PLAYER_CROSS_DIST_AWAY 40.0f
-#define CUBE_PLAYER_WARN_MAX_FACTOR 8
-#define CUBE_PLAYER_WARN_FUTURE_MAX_ITERATIONS 100
 
 #define HIGH_SCORE_USER_DEFAULTS_KEY "high_score"
 #define FULLSCREEN_USER_DEFAULTS_KEY "fullscreen"
+#define ENDLESS_MODE_USER_DEFAULTS_KEY "endless_mode"
 #define WINDOW_WIDTH_USER_DEFAULTS_KEY "window_width"
 #define WINDOW_HEIGHT_USER_DEFAULTS_KEY "window_height"
+#define TICK_RATE_USER_DEFAULTS_KEY "tick_rate"
 #define USER_DEFAULTS_NAME "dodgedanger"
 
+#define RECORD_REPLAY_ENVIRONMENT_VARIABLE "DODGE_DANGER_RECORD_REPLAY"
+#define PLAY_REPLAY_ENVIRONMENT_VARIABLE "DODGE_DANGER_PLAY_REPLAY"
+#define REPLAY_SPEED_ENVIRONMENT_VARIABLE "DODGE_DANGER_REPLAY_SPEED"
+#define REPORT_FRAME_PACING_ENVIRONMENT_VARIABLE "DODGE_DANGER_REPORT_FRAME_PACING"
+#define REPORT_RENDERER_STATISTICS_ENVIRONMENT_VARIABLE "DODGE_DANGER_REPORT_RENDERER_STATISTICS"
+
 typedef struct
 {
-    vec3_t position;
-    color4_t color;
-    bool dead;
-    bool warning;
-} Cube;
+    ZGFloat x;
+    ZGFloat y;
+    ZGFloat z;
+    uint8_t flags;
+    uint8_t colorIndex;
+} GameSnapshotCube;
 
+// What the simulation thread publishes after every step for drawing
 typedef struct
 {
     vec3_t playerPosition;
-    ZGFloat playerSpeed;
+    vec3_t previousPlayerPosition;
+    // When the step was taken and how long until the next one, for interpolating between them
+    uint64_t stepNanoTicks;
+    uint64_t stepIntervalNanoseconds;
     uint32_t score;
+    bool playerLost;
+    bool paused;
+    bool replaying;
+    bool renderInstruction;
+    bool instructionWarning;
+    // Alive cubes within view distance, in decreasing depth
+    uint32_t cubeCount;
+    GameSnapshotCube cubes[MAX_CUBE_COUNT];
+} GameSnapshot;
+
+// A change of the player's REPLAY_INPUT_* bits and when it happened, on the ZGGetNanoTicks() clock
+typedef struct
+{
+    uint64_t nanoTicks;
+    uint8_t inputState;
+} GameInputTransition;
+
+typedef struct
+{
+    // Only touched by the simulation thread while it runs
+    Simulation *simulation;
+    // Steps per second, fixed for the whole game
+    uint32_t tickRate;
+    // Counts the job generating the simulation's next cube field, if any
+    JobCounter nextFieldJobs;
     double timer;
+    bool renderInstruction;
+    // Whether the latest step was skipped for being paused, either by the player or a replay
+    bool simulationPaused;
+    // The player's input state as of the end of the latest step, and when that step ran
+    uint8_t appliedInputState;
+    uint64_t lastStepNanoTicks;
+    // A dequeued transition that happened after the step that dequeued it
+    GameInputTransition pendingInputTransition;
+    bool hasPendingInputTransition;
     
-    Cube *cubes;
+    // Steps the simulation at a steady rate, independent of how long frames take to present
+    ZGThread simulationThread;
+    ZGAtomicInt stopsSimulation;
+    // REPLAY_INPUT_* bits for the player's input, written by the main thread
+    ZGAtomicInt inputState;
+    // Every change to inputState along with when it happened, so that steps can apply it partway through
+    SPSCQueue *inputTransitions;
+    // Set when a transition didn't fit in the queue, in which case the simulation catches up to inputState
+    ZGAtomicInt droppedInputTransition;
+    // The simulation thread waits on this while the player has the game paused
+    ZGMutex resumeMutex;
+    ZGCondition resumeCondition;
+    TripleBuffer *snapshots;
+    // The most recent snapshot read by the main thread
+    const GameSnapshot *snapshot;
     
+    // Only touched by the main thread
     bool paused;
     bool playerLost;
     
@@ -101,7 +163,6 @@ typedef struct
     bool playerDirectionLeft;
     
     bool exitOptionSelected;
-    bool renderInstruction;
 } Game;
 
 // This struct only exists to add another level of indirection that makes it slightly more challenging for cheat tools to find
@@ -117,21 +178,40 @@ typedef struct
     Renderer renderer;
     
     BufferArrayObject cubeVertexArrayObject;
+    BufferArrayObject cubeObstacleVertexArrayObject;
     BufferObject cubeIndicesBufferObject;
     BufferObject cubeLineIndicesBufferObject;
     
+    RendererInstance *cubeInstances;
+    
     GamepadManager *gamepadManager;
     
-    double lastFrameTime;
-    double cyclesLeftOver;
+    // Only used to pick a seed for each new game
+    MTState gameSeedState;
+    
+    // Each game is recorded to replayRecordPath, or played back from replayPlayPath, when they are set
+    const char *replayRecordPath;
+    const char *replayPlayPath;
+    double replaySpeed;
+    ReplayRecorder *replayRecorder;
+    ReplayPlayer *replayPlayer;
     
-    ZGFloat playerCubeDiagonalSumDistance;
+    // How far rendering is between the previous and latest simulation steps
+    ZGFloat interpolationFactor;
     
-    uint32_t lastRunloopTime;
+    // Caps the frame rate when vsync isn't pacing us
+    FramePacer framePacer;
     
     uint32_t highScore;
     
+    bool endlessMode;
+    // Steps per second for new games, one of the rates isSupportedSimulationTickRate() accepts
+    uint32_t tickRate;
     bool needsToDrawScene;
+    // Idle scenes (menus, pausing and game over) are only redrawn when something shown in them changes
+    bool sceneIsIdle;
+    bool sceneIsDirty;
+    bool textWasRasterizing;
     bool playOptionSelected;
 } AppContext;
 
@@ -168,10 +248,12 @@ static void drawScene(Renderer *renderer, void *context)
     else
     {
         Game *game = gameSeries->game;
+        const GameSnapshot *snapshot = game->snapshot;
         
         mat4_t worldRotationMatrix = m4_rotation_x(0.0f * ((ZGFloat)M_PI / 180.0f));
         
-        vec3_t playerPosition = game->playerPosition;
+        // Steps happen at a fixed rate, so blend between the last two to move smoothly on displays that refresh faster
+        vec3_t playerPosition = v3_add(snapshot->previousPlayerPosition, v3_muls(v3_sub(snapshot->playerPosition, snapshot->previousPlayerPosition), appContext->interpolationFactor));
         
         mat4_t playerModelTranslationMatrix = m4_translation((vec3_t){-playerPosition.x, -playerPosition.y, -playerPosition.z});
         
@@ -186,37 +268,44 @@ static void drawScene(Renderer *renderer, void *context)
         }
         
         // Draw cubes
-        Cube *cubes = game->cubes;
-        for (uint32_t cubeIndex = 0; cubeIndex < MAX_CUBE_COUNT; cubeIndex++)
+        // Cubes close enough to the player also render their front X, so they are batched separately
+        // Near cubes fill the instance buffer from the front and far cubes fill it from the back
         {
-            if (cubes[cubeIndex].dead || cubes[cubeIndex].position.z < playerPosition.z - CUBE_PLAYER_DIST_AWAY)
-            {
-                continue;
-            }
-            
-            vec3_t cubePosition = cubes[cubeIndex].position;
-            mat4_t cubeModelTranslationMatrix = m4_mul(playerModelTranslationMatrix, m4_translation(cubePosition));
-            
-            mat4_t rotatedModelViewMatrix = m4_mul(worldRotationMatrix, cubeModelTranslationMatrix);
-            // Make sure cubes don't quite touch each other from rendering perspective
-            mat4_t scalingMatrix = m4_scaling(vec3(0.99f, 1.0f, 1.0f));
-            mat4_t modelViewMatrix = m4_mul(rotatedModelViewMatrix, scalingMatrix);
-            
-            color4_t cubeColor = cubes[cubeIndex].warning ? (color4_t){1.0f, 1.0f, 0.0f, 1.0f} : cubes[cubeIndex].color;
+            RendererInstance *cubeInstances = appContext->cubeInstances;
+            const color4_t cubeColors[CUBE_COLOR_COUNT] = {(color4_t){0.0f, 1.0f, 0.0f, 1.0f}, (color4_t){0.0f, 0.0f, 1.0f, 1.0f}, (color4_t){0.7f, 0.0f, 0.0f, 1.0f}, (color4_t){1.0f, 0.0f, 1.0f, 1.0f}, (color4_t){0.2f, 0.2f, 0.5f, 1.0f}};
+            uint32_t nearCubeCount = 0;
+            uint32_t farCubeCount = 0;
             
+            for (uint32_t snapshotCubeIndex = 0; snapshotCubeIndex < snapshot->cubeCount; snapshotCubeIndex++)
             {
-                uint32_t indicesCount;
-                if (cubes[cubeIndex].position.z < playerPosition.z - CUBE_PLAYER_CROSS_DIST_AWAY)
+                const GameSnapshotCube *cube = &snapshot->cubes[snapshotCubeIndex];
+                
+                ZGFloat cubeDepth = cube->z;
+                color4_t cubeColor = ((cube->flags & CUBE_FLAG_WARNING) != 0) ? (color4_t){1.0f, 1.0f, 0.0f, 1.0f} : cubeColors[cube->colorIndex];
+                
+                RendererInstance *cubeInstance;
+                if (cubeDepth < playerPosition.z - CUBE_PLAYER_CROSS_DIST_AWAY)
                 {
-                    indicesCount = 48;
+                    farCubeCount++;
+                    cubeInstance = &cubeInstances[MAX_CUBE_COUNT - farCubeCount];
                 }
                 else
                 {
-                    indicesCount = 52;
+                    cubeInstance = &cubeInstances[nearCubeCount];
+                    nearCubeCount++;
                 }
                 
-                drawVerticesFromIndices(renderer, modelViewMatrix, RENDERER_LINE_MODE, appContext->cubeVertexArrayObject, appContext->cubeLineIndicesBufferObject, indicesCount, cubeColor, RENDERER_OPTION_NONE);
+                cubeInstance->translation[0] = cube->x;
+                cubeInstance->translation[1] = cube->y;
+                cubeInstance->translation[2] = cubeDepth;
+                cubeInstance->color = cubeColor;
             }
+            
+            mat4_t modelViewMatrix = m4_mul(worldRotationMatrix, playerModelTranslationMatrix);
+            
+            drawVerticesFromIndicesInstanced(renderer, modelViewMatrix, RENDERER_LINE_MODE, appContext->cubeObstacleVertexArrayObject, appContext->cubeLineIndicesBufferObject, 52, cubeInstances, nearCubeCount, RENDERER_OPTION_NONE);
+            
+            drawVerticesFromIndicesInstanced(renderer, modelViewMatrix, RENDERER_LINE_MODE, appContext->cubeObstacleVertexArrayObject, appContext->cubeLineIndicesBufferObject, 48, &cubeInstances[MAX_CUBE_COUNT - farCubeCount], farCubeCount, RENDERER_OPTION_NONE);
         }
         
         // Draw score
@@ -227,15 +316,15 @@ static void drawScene(Renderer *renderer, void *context)
             mat4_t scoreModelViewMatrix = m4_translation((vec3_t){-42.0f, 26.0f, -70.0f});
             
             char scoreBuffer[256] = {0};
-            snprintf(scoreBuffer, sizeof(scoreBuffer) - 1, "Score: %u", game->score);
+            snprintf(scoreBuffer, sizeof(scoreBuffer) - 1, "Score: %u", snapshot->score);
             drawStringLeftAligned(renderer, scoreModelViewMatrix, color, scale, scoreBuffer);
         }
         
         // Draw dodge!
-        if (game->renderInstruction)
+        if (snapshot->renderInstruction)
         {
             ZGFloat scale = 0.01f;
-            color4_t color = cubes[0].warning ? (color4_t){1.0f, 1.0f, 0.0f, 1.0f} : (color4_t){1.0f, 1.0f, 1.0f, 1.0f};
+            color4_t color = snapshot->instructionWarning ? (color4_t){1.0f, 1.0f, 0.0f, 1.0f} : (color4_t){1.0f, 1.0f, 1.0f, 1.0f};
             
             mat4_t scoreModelViewMatrix = m4_translation((vec3_t){0.0f, 14.0f, -70.0f});
             
@@ -270,7 +359,7 @@ static void drawScene(Renderer *renderer, void *context)
                 drawStringScaled(renderer, exitModelViewMatrix, exitOptionSelected ? selectedColor : nonSelectedColor, scale, "Exit");
             }
         }
-        else if (game->paused)
+        else if (game->paused || snapshot->paused)
         {
             ZGFloat scale = 0.01f;
             color4_t selectedColor = (color4_t){1.0f, 1.0f, 1.0f, 1.0f};
@@ -287,122 +376,177 @@ static void drawScene(Renderer *renderer, void *context)
     }
 }
 
-static void generateCubePositions(Game *game, uint32_t startingIndex)
+static void finishRecordingReplay(AppContext *appContext)
 {
-    game->playerPosition = vec3(0.0f, 0.0f, 20.0f);
-    
-    Cube *cubes = game->cubes;
-    
-    cubes[0].position = vec3(0.0f, 0.0f, 0.0f);
-    cubes[0].color = (color4_t){0.0f, 1.0f, 0.0f, 1.0f};
-    cubes[0].dead = false;
-    cubes[0].warning = false;
-    
-    uint32_t currentCubeIndex = startingIndex;
-    ZGFloat startDepth = startingIndex > 0 ? -CUBE_MAGNITUDE * 2 * 5 : 0.0f;
-    
-    color4_t colors[] = {(color4_t){0.0f, 1.0f, 0.0f, 1.0f}, (color4_t){0.0f, 0.0f, 1.0f, 1.0f}, (color4_t){0.7f, 0.0f, 0.0f, 1.0f}, (color4_t){1.0f, 0.0f, 1.0f, 1.0f}, (color4_t){0.2f, 0.2f, 0.5f, 1.0f}};
-    
-    const uint32_t maxCountPerExpertLevel = 5;
-    const uint32_t maxCountPerMediumLevel = 4;
-    const uint32_t maxCountPerBeginnerLevel = 3;
+    if (appContext->replayRecorder != NULL)
+    {
+        writeReplay(appContext->replayRecorder, appContext->replayRecordPath);
+        destroyReplayRecorder(appContext->replayRecorder);
+        appContext->replayRecorder = NULL;
+    }
+}
+
+// Takes the next input transition that happened by stepNanoTicks
+static bool nextInputTransition(Game *game, uint64_t stepNanoTicks, GameInputTransition *transition)
+{
+    if (!game->hasPendingInputTransition)
+    {
+        if (!popSPSCQueue(game->inputTransitions, &game->pendingInputTransition))
+        {
+            return false;
+        }
+        game->hasPendingInputTransition = true;
+    }
     
-    const uint32_t cubeCountForMediumLevelEntry = 50;
-    const uint32_t cubeCountForExpertLevelEntry = 100;
+    // Transitions that happened after this step are left for the next one
+    if (game->pendingInputTransition.nanoTicks > stepNanoTicks)
+    {
+        return false;
+    }
     
-    uint32_t *prevRandomXIndices = calloc(maxCountPerExpertLevel, sizeof(*prevRandomXIndices));
-    const uint32_t maxDepthIncreaseCount = 5;
+    *transition = game->pendingInputTransition;
+    game->hasPendingInputTransition = false;
+    return true;
+}
+
+// Adds a change partway through a step, keeping within REPLAY_MAX_TICK_INPUT_CHANGES changes that each differ from the state before them
+static void addInputChange(uint8_t startInputState, ReplayInputChange *changes, uint32_t *changeCount, uint8_t inputState, uint8_t subdivision)
+{
+    if (*changeCount < REPLAY_MAX_TICK_INPUT_CHANGES)
+    {
+        changes[*changeCount].inputState = inputState;
+        changes[*changeCount].subdivision = subdivision;
+        (*changeCount)++;
+    }
+    else
+    {
+        // Too much is going on in one step, so fold the rest into the last change
+        changes[*changeCount - 1].inputState = inputState;
+        
+        uint8_t previousInputState = (*changeCount > 1) ? changes[*changeCount - 2].inputState : startInputState;
+        if (previousInputState == inputState)
+        {
+            (*changeCount)--;
+        }
+    }
+}
+
+// Turns the player's input transitions since the previous step into the input state this step starts with and changes partway through it
+static uint8_t gatherPlayerInput(Game *game, uint64_t stepNanoTicks, ReplayInputChange *changes, uint32_t *changeCount)
+{
+    uint64_t previousStepNanoTicks = game->lastStepNanoTicks;
+    uint64_t stepNanoseconds = (stepNanoTicks > previousStepNanoTicks) ? stepNanoTicks - previousStepNanoTicks : 0;
     
-    const uint32_t maxCubesPerLevel = (uint32_t)((MAX_BOUNDARY_X_MAGNITUDE * 2.0f) / (CUBE_MAGNITUDE * 2.0f));
+    uint8_t startInputState = game->appliedInputState;
+    uint8_t inputState = startInputState;
+    *changeCount = 0;
     
-    while (currentCubeIndex < MAX_CUBE_COUNT)
+    if (ZGAtomicExchange(&game->droppedInputTransition, 0) != 0)
     {
-        uint32_t maxCountPerLevel;
-        if (currentCubeIndex < cubeCountForMediumLevelEntry)
+        startInputState = (uint8_t)ZGAtomicLoad(&game->inputState);
+        inputState = startInputState;
+        
+        // Whatever is still queued is older than the state just caught up to
+        GameInputTransition staleTransition;
+        while (nextInputTransition(game, UINT64_MAX, &staleTransition))
         {
-            maxCountPerLevel = maxCountPerBeginnerLevel;
         }
-        else if (currentCubeIndex < cubeCountForExpertLevelEntry)
+    }
+    
+    GameInputTransition transition;
+    while (nextInputTransition(game, stepNanoTicks, &transition))
+    {
+        if (transition.inputState == inputState)
         {
-            maxCountPerLevel = maxCountPerMediumLevel;
+            continue;
         }
-        else
+        
+        // Changes are quantized the same way replays store them so that replays play back exactly
+        uint32_t subdivision = 0;
+        if (transition.nanoTicks > previousStepNanoTicks && stepNanoseconds > 0)
         {
-            maxCountPerLevel = maxCountPerExpertLevel;
+            subdivision = (uint32_t)((transition.nanoTicks - previousStepNanoTicks) * REPLAY_TICK_SUBDIVISIONS / stepNanoseconds);
+            if (subdivision >= REPLAY_TICK_SUBDIVISIONS)
+            {
+                subdivision = REPLAY_TICK_SUBDIVISIONS - 1;
+            }
         }
         
-        uint32_t countPerLevel;
-        if (MAX_CUBE_COUNT - currentCubeIndex < maxCountPerLevel)
+        // Keyboards and gamepads aren't necessarily timestamped in the order their events arrive
+        if (*changeCount > 0 && subdivision < changes[*changeCount - 1].subdivision)
         {
-            countPerLevel = (uint32_t)(mt_random() % (MAX_CUBE_COUNT - currentCubeIndex)) + 1;
+            subdivision = changes[*changeCount - 1].subdivision;
         }
-        else
+        
+        if (subdivision == 0)
         {
-            countPerLevel = (uint32_t)(mt_random() % maxCountPerLevel) + 1;
+            startInputState = transition.inputState;
         }
-        
-        for (uint32_t cubeLevelIndex = 0; cubeLevelIndex < countPerLevel; cubeLevelIndex++)
+        else
         {
-            uint32_t randomXIndex;
-            do
-            {
-                uint32_t randomNumber = (uint32_t)(mt_random() % maxCubesPerLevel);
-                if (cubeLevelIndex == 0)
-                {
-                    randomXIndex = randomNumber;
-                    prevRandomXIndices[cubeLevelIndex] = randomXIndex;
-                    break;
-                }
-                else
-                {
-                    bool foundPrevRandomIndex = false;
-                    for (uint32_t prevIndex = 0; prevIndex < cubeLevelIndex; prevIndex++)
-                    {
-                        if (prevRandomXIndices[prevIndex] == randomNumber)
-                        {
-                            foundPrevRandomIndex = true;
-                            break;
-                        }
-                    }
-                    
-                    if (!foundPrevRandomIndex)
-                    {
-                        randomXIndex = randomNumber;
-                        prevRandomXIndices[cubeLevelIndex] = randomXIndex;
-                        break;
-                    }
-                }
-            }
-            while (true);
-            
-            vec3_t cubePosition = vec3((ZGFloat)(-MAX_BOUNDARY_X_MAGNITUDE + CUBE_MAGNITUDE) + (ZGFloat)randomXIndex * (CUBE_MAGNITUDE * 2), 0.0f, startDepth);
-            cubes[currentCubeIndex].position = cubePosition;
-            
-            uint32_t colorIndex = (uint32_t)(mt_random() % (sizeof(colors) / sizeof(colors[0])));
-            cubes[currentCubeIndex].color = colors[colorIndex];
-            cubes[currentCubeIndex].dead = false;
-            cubes[currentCubeIndex].warning = false;
-            
-            currentCubeIndex++;
+            addInputChange(startInputState, changes, changeCount, transition.inputState, (uint8_t)subdivision);
         }
-        
-        uint32_t depthDecrease = (uint32_t)(mt_random() % maxDepthIncreaseCount);
-        startDepth -= CUBE_MAGNITUDE * 2 * (2 + depthDecrease);
+        inputState = transition.inputState;
     }
     
-    free(prevRandomXIndices);
+    game->appliedInputState = inputState;
+    
+    return startInputState;
 }
 
-static void animate(double timeDelta, AppContext *appContext)
+static SimulationInput simulationInputFromState(uint8_t inputState)
 {
-    GameSeries *gameSeries = appContext->gameSeries;
-    if (gameSeries == NULL)
+    SimulationInput input;
+    input.left = (inputState & REPLAY_INPUT_LEFT) != 0;
+    input.right = (inputState & REPLAY_INPUT_RIGHT) != 0;
+    return input;
+}
+
+// Runs on the simulation thread for the step that ends at stepNanoTicks
+static void animate(double timeDelta, uint64_t stepNanoTicks, AppContext *appContext)
+{
+    Game *game = appContext->gameSeries->game;
+    
+    ReplayInputChange changes[REPLAY_MAX_TICK_INPUT_CHANGES];
+    uint32_t changeCount;
+    uint8_t inputState = gatherPlayerInput(game, stepNanoTicks, changes, &changeCount);
+    
+    // The player pausing holds a replay where it is, so no replay ticks are used up until the player resumes
+    uint8_t playerEndInputState = (changeCount > 0) ? changes[changeCount - 1].inputState : inputState;
+    if (appContext->replayPlayer != NULL && (playerEndInputState & REPLAY_INPUT_PAUSED) == 0)
     {
-        return;
+        uint8_t replayInputState;
+        ReplayInputChange replayChanges[REPLAY_MAX_TICK_INPUT_CHANGES];
+        uint32_t replayChangeCount;
+        if (nextReplayTickWithInputChanges(appContext->replayPlayer, &replayInputState, replayChanges, &replayChangeCount))
+        {
+            inputState = replayInputState;
+            memcpy(changes, replayChanges, replayChangeCount * sizeof(*changes));
+            changeCount = replayChangeCount;
+        }
+        else
+        {
+            // Hand control back to the player once the replay runs out
+            destroyReplayPlayer(appContext->replayPlayer);
+            appContext->replayPlayer = NULL;
+        }
     }
     
-    Game *game = gameSeries->game;
-    if (game == NULL || game->playerLost || game->paused)
+    // Pausing and resuming only take effect on whole steps
+    uint8_t endInputState = (changeCount > 0) ? changes[changeCount - 1].inputState : inputState;
+    if (((inputState | endInputState) & REPLAY_INPUT_PAUSED) != 0)
+    {
+        inputState = endInputState;
+        changeCount = 0;
+    }
+    
+    if (appContext->replayRecorder != NULL)
+    {
+        recordReplayTickWithInputChanges(appContext->replayRecorder, inputState, changes, changeCount);
+    }
+    
+    game->simulationPaused = (inputState & REPLAY_INPUT_PAUSED) != 0;
+    if (game->simulationPaused)
     {
         return;
     }
@@ -414,114 +558,259 @@ static void animate(double timeDelta, AppContext *appContext)
         game->renderInstruction = false;
     }
     
-    ZGFloat deltaX;
-    if (game->playerDirectionRight && game->playerDirectionLeft)
-    {
-        deltaX = 0.0f;
-    }
-    else if (game->playerDirectionRight && game->playerPosition.x + PLAYER_MAGNITUDE <= (ZGFloat)MAX_BOUNDARY_X_MAGNITUDE)
+    SimulationInputChange simulationChanges[REPLAY_MAX_TICK_INPUT_CHANGES];
+    for (uint32_t changeIndex = 0; changeIndex < changeCount; changeIndex++)
     {
-        deltaX = 1.0f;
+        simulationChanges[changeIndex].input = simulationInputFromState(changes[changeIndex].inputState);
+        simulationChanges[changeIndex].stepFraction = (double)changes[changeIndex].subdivision / REPLAY_TICK_SUBDIVISIONS;
     }
-    else if (game->playerDirectionLeft && game->playerPosition.x - PLAYER_MAGNITUDE >= (ZGFloat)(-MAX_BOUNDARY_X_MAGNITUDE))
+    
+    stepSimulationWithInputChanges(game->simulation, simulationInputFromState(inputState), simulationChanges, changeCount, timeDelta);
+    
+    SimulationObservation observation = observeSimulation(game->simulation);
+    if (observation.playerLost)
     {
-        deltaX = -1.0f;
+        // Player loses here
+        finishRecordingReplay(appContext);
     }
-    else
+}
+
+static uint64_t simulationStepIntervalNanoseconds(AppContext *appContext)
+{
+    double stepInterval = simulationTickInterval(appContext->gameSeries->game->tickRate);
+    if (appContext->replayPlayer != NULL)
     {
-        deltaX = 0.0f;
+        stepInterval /= appContext->replaySpeed;
     }
+    return (uint64_t)(stepInterval * 1000000000.0);
+}
+
+// Called by the simulation thread after every step, or by the main thread before it starts
+static void publishGameSnapshot(AppContext *appContext, Game *game)
+{
+    GameSnapshot *snapshot = tripleBufferWriteBuffer(game->snapshots);
+    SimulationObservation observation = observeSimulation(game->simulation);
     
-    vec3_t deltaVector = v3_muls(v3_norm(vec3(deltaX, 0.0f, -1.0f)), (ZGFloat)(timeDelta * game->playerSpeed));
-    game->playerPosition = v3_add(game->playerPosition, deltaVector);
-    
-    vec3_t playerPosition = game->playerPosition;
+    snapshot->playerPosition = observation.playerPosition;
+    snapshot->previousPlayerPosition = observation.previousPlayerPosition;
+    snapshot->stepNanoTicks = ZGGetNanoTicks();
+    snapshot->stepIntervalNanoseconds = simulationStepIntervalNanoseconds(appContext);
+    snapshot->score = observation.score;
+    snapshot->playerLost = observation.playerLost;
+    snapshot->replaying = (appContext->replayPlayer != NULL);
+    snapshot->paused = game->simulationPaused;
+    snapshot->renderInstruction = game->renderInstruction;
+    snapshot->instructionWarning = (observation.cubeFlags[0] & CUBE_FLAG_WARNING) != 0;
     
-    bool foundAliveCube = false;
-    Cube *cubes = game->cubes;
-    for (uint32_t cubeIndex = 0; cubeIndex < MAX_CUBE_COUNT; cubeIndex++)
+    uint32_t cubeCount = 0;
+    uint32_t cubeWindowEnd = observation.cubeWindowEnd;
+    for (uint32_t windowIndex = observation.cubeWindowStart; windowIndex < cubeWindowEnd; windowIndex++)
     {
-        Cube cube = cubes[cubeIndex];
-        if (cube.dead)
+        uint32_t cubeIndex = windowIndex & observation.cubeIndexMask;
+        uint8_t cubeFlags = observation.cubeFlags[cubeIndex];
+        if ((cubeFlags & CUBE_FLAG_DEAD) != 0)
         {
             continue;
         }
         
-        foundAliveCube = true;
+        GameSnapshotCube *cube = &snapshot->cubes[cubeCount];
+        cube->x = observation.cubeXs[cubeIndex];
+        cube->y = observation.cubeYs[cubeIndex];
+        cube->z = observation.cubeZs[cubeIndex];
+        cube->flags = cubeFlags;
+        cube->colorIndex = observation.cubeColorIndices[cubeIndex];
+        cubeCount++;
+    }
+    snapshot->cubeCount = cubeCount;
+    
+    publishTripleBuffer(game->snapshots);
+}
+
+static int simulationThread(void *context)
+{
+    AppContext *appContext = context;
+    Game *game = appContext->gameSeries->game;
+    
+    FramePacer stepPacer = {0};
+    initFramePacer(&stepPacer);
+    
+    game->lastStepNanoTicks = ZGGetNanoTicks();
+    
+    // Nothing changes once the player loses, so the thread is done then
+    while (ZGAtomicLoad(&game->stopsSimulation) == 0 && !observeSimulation(game->simulation).playerLost)
+    {
+        paceFrame(&stepPacer, simulationStepIntervalNanoseconds(appContext));
         
-        ZGFloat distance = sqrtf((cube.position.x - playerPosition.x) * (cube.position.x - playerPosition.x) + (cube.position.y - playerPosition.y) * (cube.position.y - playerPosition.y) + (cube.position.z - playerPosition.z) * (cube.position.z - playerPosition.z));
+        uint64_t stepNanoTicks = ZGGetNanoTicks();
+        animate(simulationTickInterval(game->tickRate), stepNanoTicks, appContext);
+        game->lastStepNanoTicks = stepNanoTicks;
         
-        if (distance <= appContext->playerCubeDiagonalSumDistance)
-        {
-            // Player loses here
-            game->playerLost = true;
-            if (game->score > appContext->highScore)
-            {
-                appContext->highScore = game->score;
-            }
-            
-            gameSeries->numberOfGamesPlayed++;
-            
-            ZGAppSetAllowsScreenIdling(true);
-            break;
-        }
-        else if (playerPosition.z - PLAYER_MAGNITUDE < cube.position.z + CUBE_MAGNITUDE)
-        {
-            cubes[cubeIndex].dead = true;
-            game->score++;
-            
-            if (game->playerSpeed < PLAYER_SPEED_CAP)
-            {
-                game->playerSpeed += PLAYER_SPEED_INCREASE;
-                if (game->playerSpeed > PLAYER_SPEED_CAP)
-                {
-                    game->playerSpeed = PLAYER_SPEED_CAP;
-                }
-            }
-        }
-        else if (distance <= appContext->playerCubeDiagonalSumDistance * CUBE_PLAYER_WARN_MAX_FACTOR)
+        publishGameSnapshot(appContext, game);
+        
+        // Nothing steps while the player has the game paused, so wait to be resumed instead of pacing idle steps
+        if ((game->appliedInputState & REPLAY_INPUT_PAUSED) != 0)
         {
-            bool foundFutureCollision = false;
-            vec3_t playerPositionInFuture = v3_add(game->playerPosition, deltaVector);
-            for (uint32_t collideInFutureIndex = 0; collideInFutureIndex < CUBE_PLAYER_WARN_FUTURE_MAX_ITERATIONS; collideInFutureIndex++)
+            ZGLockMutex(game->resumeMutex);
+            while ((ZGAtomicLoad(&game->inputState) & REPLAY_INPUT_PAUSED) != 0 && ZGAtomicLoad(&game->stopsSimulation) == 0)
             {
-                playerPositionInFuture = v3_add(playerPositionInFuture, deltaVector);
-                
-                ZGFloat collideInFutureDistance = sqrtf((cube.position.x - playerPositionInFuture.x) * (cube.position.x - playerPositionInFuture.x) + (cube.position.y - playerPositionInFuture.y) * (cube.position.y - playerPositionInFuture.y) + (cube.position.z - playerPositionInFuture.z) * (cube.position.z - playerPositionInFuture.z));
-                
-                if (collideInFutureDistance <= appContext->playerCubeDiagonalSumDistance)
-                {
-                    foundFutureCollision = true;
-                    break;
-                }
-                else if (playerPositionInFuture.z - PLAYER_MAGNITUDE < cube.position.z + CUBE_MAGNITUDE)
-                {
-                    break;
-                }
+                ZGWaitCondition(game->resumeCondition, game->resumeMutex);
             }
+            ZGUnlockMutex(game->resumeMutex);
             
-            cubes[cubeIndex].warning = foundFutureCollision;
-        }
-        else
-        {
-            cubes[cubeIndex].warning = false;
+            // Steps pick up a full interval after resuming rather than catching up on the time spent paused
+            resetFramePacer(&stepPacer);
+            paceFrame(&stepPacer, simulationStepIntervalNanoseconds(appContext));
+            game->lastStepNanoTicks = ZGGetNanoTicks();
         }
     }
     
-    if (!foundAliveCube)
+    destroyFramePacer(&stepPacer);
+    
+    return 0;
+}
+
+static void startSimulationThread(AppContext *appContext, Game *game)
+{
+    game->snapshots = createTripleBuffer(sizeof(GameSnapshot));
+    game->inputTransitions = createSPSCQueue(MAX_INPUT_TRANSITION_COUNT, sizeof(GameInputTransition));
+    if (game->snapshots == NULL || game->inputTransitions == NULL)
+    {
+        fprintf(stderr, "Error: failed to allocate game snapshots\n");
+        ZGQuit();
+    }
+    game->resumeMutex = ZGCreateMutex();
+    game->resumeCondition = ZGCreateCondition();
+    
+    // Make sure there's something to draw before the first step
+    publishGameSnapshot(appContext, game);
+    game->snapshot = readTripleBuffer(game->snapshots, NULL);
+    
+    game->simulationThread = ZGCreateThread(simulationThread, "simulation", appContext);
+    if (game->simulationThread == NULL)
     {
-        generateCubePositions(game, 0);
+        fprintf(stderr, "Error: failed to create simulation thread\n");
+        ZGQuit();
     }
 }
 
+static void stopSimulationThread(Game *game)
+{
+    if (game->simulationThread != NULL)
+    {
+        ZGAtomicStore(&game->stopsSimulation, 1);
+        
+        ZGLockMutex(game->resumeMutex);
+        ZGSignalCondition(game->resumeCondition);
+        ZGUnlockMutex(game->resumeMutex);
+        
+        ZGWaitThread(game->simulationThread);
+        game->simulationThread = NULL;
+    }
+}
+
+// Hands the player's input over to the simulation thread, as of timestamp on the ZGGetNanoTicks() clock
+static void publishGameInput(AppContext *appContext, uint64_t timestamp)
+{
+    GameSeries *gameSeries = appContext->gameSeries;
+    if (gameSeries == NULL || gameSeries->game == NULL)
+    {
+        return;
+    }
+    
+    Game *game = gameSeries->game;
+    
+    uint8_t inputState = 0;
+    if (game->playerDirectionLeft)
+    {
+        inputState |= REPLAY_INPUT_LEFT;
+    }
+    if (game->playerDirectionRight)
+    {
+        inputState |= REPLAY_INPUT_RIGHT;
+    }
+    if (game->paused)
+    {
+        inputState |= REPLAY_INPUT_PAUSED;
+    }
+    
+    if (inputState == (uint8_t)ZGAtomicLoad(&game->inputState))
+    {
+        return;
+    }
+    
+    GameInputTransition transition;
+    transition.nanoTicks = (timestamp != 0) ? timestamp : ZGGetNanoTicks();
+    transition.inputState = inputState;
+    bool queued = pushSPSCQueue(game->inputTransitions, &transition);
+    
+    ZGAtomicStore(&game->inputState, inputState);
+    
+    // Flag the dropped transition only after the state it leads to is in place
+    if (!queued)
+    {
+        ZGAtomicStore(&game->droppedInputTransition, 1);
+    }
+    
+    // Wakes the simulation thread if it's waiting out a pause
+    ZGLockMutex(game->resumeMutex);
+    ZGSignalCondition(game->resumeCondition);
+    ZGUnlockMutex(game->resumeMutex);
+}
+
+// Nothing animates in the menus, while paused or after losing, unless a replay is driving the game
+static bool isSceneIdle(AppContext *appContext)
+{
+    GameSeries *gameSeries = appContext->gameSeries;
+    if (gameSeries == NULL)
+    {
+        return true;
+    }
+    
+    Game *game = gameSeries->game;
+    if (game->paused)
+    {
+        return true;
+    }
+    if (game->snapshot->replaying)
+    {
+        return false;
+    }
+    return game->playerLost;
+}
+
 static void appTerminatedHandler(void *context)
 {
     AppContext *appContext = context;
     
+    GameSeries *gameSeries = appContext->gameSeries;
+    if (gameSeries != NULL)
+    {
+        stopSimulationThread(gameSeries->game);
+    }
+    
+    // Lets in-flight work such as text rasterization finish before the process goes away
+    shutdownJobSystem();
+    
+    finishRecordingReplay(appContext);
+    
+    if (getenv(REPORT_FRAME_PACING_ENVIRONMENT_VARIABLE) != NULL)
+    {
+        reportFramePacerStatistics(&appContext->framePacer);
+    }
+    
+    if (getenv(REPORT_RENDERER_STATISTICS_ENVIRONMENT_VARIABLE) != NULL)
+    {
+        reportRendererStatistics(&appContext->renderer);
+    }
+    
+    destroyFramePacer(&appContext->framePacer);
+    
     Defaults userDefaults = userDefaultsForWriting(USER_DEFAULTS_NAME);
     
     writeDefaultIntKey(userDefaults, HIGH_SCORE_USER_DEFAULTS_KEY, (int)appContext->highScore);
     writeDefaultIntKey(userDefaults, FULLSCREEN_USER_DEFAULTS_KEY, (int)appContext->renderer.fullscreen);
+    writeDefaultIntKey(userDefaults, ENDLESS_MODE_USER_DEFAULTS_KEY, (int)appContext->endlessMode);
+    writeDefaultIntKey(userDefaults, TICK_RATE_USER_DEFAULTS_KEY, (int)appContext->tickRate);
     writeDefaultIntKey(userDefaults, WINDOW_WIDTH_USER_DEFAULTS_KEY, (int)appContext->renderer.windowWidth);
     writeDefaultIntKey(userDefaults, WINDOW_HEIGHT_USER_DEFAULTS_KEY, (int)appContext->renderer.windowHeight);
     
@@ -534,6 +823,8 @@ static void handleWindowEvent(ZGWindowEvent event, void *context)
     GameSeries *gameSeries = appContext->gameSeries;
     Game *game = (gameSeries != NULL) ? gameSeries->game : NULL;
     
+    appContext->sceneIsDirty = true;
+    
     switch (event.type)
     {
         case ZGWindowEventTypeResize:
@@ -550,11 +841,11 @@ static void handleWindowEvent(ZGWindowEvent event, void *context)
             break;
         case ZGWindowEventTypeShown:
             appContext->needsToDrawScene = true;
-            appContext->lastRunloopTime = 0;
+            resetFramePacer(&appContext->framePacer);
             break;
         case ZGWindowEventTypeHidden:
             appContext->needsToDrawScene = false;
-            appContext->lastRunloopTime = 0;
+            resetFramePacer(&appContext->framePacer);
             break;
 #if PLATFORM_WINDOWS
         case ZGWindowEventDeviceConnected:
@@ -562,6 +853,25 @@ static void handleWindowEvent(ZGWindowEvent event, void *context)
             break;
 #endif
     }
+    
+    publishGameInput(appContext, ZGGetNanoTicks());
+}
+
+static void generateNextCubeFieldJob(void *context)
+{
+    generateSimulationNextField(context);
+}
+
+static void requestNextCubeField(Simulation *simulation, void *context)
+{
+    Game *game = context;
+    submitJob(generateNextCubeFieldJob, simulation, &game->nextFieldJobs);
+}
+
+static void waitForNextCubeField(Simulation *simulation, void *context)
+{
+    Game *game = context;
+    waitForJobs(&game->nextFieldJobs);
 }
 
 static void destroyGame(AppContext *appContext)
@@ -569,12 +879,26 @@ static void destroyGame(AppContext *appContext)
     GameSeries *gameSeries = appContext->gameSeries;
     if (gameSeries != NULL)
     {
-        free(gameSeries->game->cubes);
+        stopSimulationThread(gameSeries->game);
+        waitForJobs(&gameSeries->game->nextFieldJobs);
+        destroySimulation(gameSeries->game->simulation);
+        destroyTripleBuffer(gameSeries->game->snapshots);
+        destroySPSCQueue(gameSeries->game->inputTransitions);
+        ZGDestroyCondition(gameSeries->game->resumeCondition);
+        ZGDestroyMutex(gameSeries->game->resumeMutex);
         free(gameSeries->game);
         free(gameSeries);
         appContext->gameSeries = NULL;
     }
     
+    finishRecordingReplay(appContext);
+    
+    if (appContext->replayPlayer != NULL)
+    {
+        destroyReplayPlayer(appContext->replayPlayer);
+        appContext->replayPlayer = NULL;
+    }
+    
     ZGAppSetAllowsScreenIdling(true);
 }
 
@@ -589,18 +913,75 @@ static void createNewGame(AppContext *appContext)
     Game *oldGame = gameSeries->game;
     if (oldGame != NULL)
     {
-        free(oldGame->cubes);
+        stopSimulationThread(oldGame);
+        waitForJobs(&oldGame->nextFieldJobs);
+        destroySimulation(oldGame->simulation);
+        destroyTripleBuffer(oldGame->snapshots);
+        destroySPSCQueue(oldGame->inputTransitions);
+        ZGDestroyCondition(oldGame->resumeCondition);
+        ZGDestroyMutex(oldGame->resumeMutex);
         free(oldGame);
     }
     
     Game *newGame = calloc(1, sizeof(*newGame));
     gameSeries->game = newGame;
-    newGame->playerSpeed = PLAYER_INITIAL_SPEED;
     newGame->renderInstruction = true;
     
-    newGame->cubes = calloc(MAX_CUBE_COUNT, sizeof(newGame->cubes[0]));
+    if (appContext->replayPlayer != NULL)
+    {
+        destroyReplayPlayer(appContext->replayPlayer);
+        appContext->replayPlayer = NULL;
+    }
+    
+    if (appContext->replayPlayPath != NULL)
+    {
+        appContext->replayPlayer = loadReplay(appContext->replayPlayPath);
+    }
+    
+    // Replays must be played back at the rate they were recorded at
+    newGame->tickRate = appContext->tickRate;
+    if (appContext->replayPlayer != NULL)
+    {
+        uint16_t recordedTickRate = replayTickRate(appContext->replayPlayer);
+        if (isSupportedSimulationTickRate(recordedTickRate))
+        {
+            newGame->tickRate = recordedTickRate;
+        }
+        else
+        {
+            fprintf(stderr, "Error: replay %s has an unsupported tick rate of %u\n", appContext->replayPlayPath, recordedTickRate);
+            destroyReplayPlayer(appContext->replayPlayer);
+            appContext->replayPlayer = NULL;
+        }
+    }
+    
+    SimulationMode mode = appContext->endlessMode ? SIMULATION_MODE_ENDLESS : SIMULATION_MODE_CLASSIC;
+    uint32_t seed;
+    if (appContext->replayPlayer != NULL)
+    {
+        mode = (replayGameMode(appContext->replayPlayer) == SIMULATION_MODE_ENDLESS) ? SIMULATION_MODE_ENDLESS : SIMULATION_MODE_CLASSIC;
+        seed = replaySeed(appContext->replayPlayer);
+    }
+    else
+    {
+        seed = mt_next(&appContext->gameSeedState);
+    }
+    
+    newGame->simulation = createSimulation(mode, seed);
+    
+    SimulationFieldGenerator fieldGenerator;
+    fieldGenerator.requestNextField = requestNextCubeField;
+    fieldGenerator.waitForNextField = waitForNextCubeField;
+    fieldGenerator.context = newGame;
+    setSimulationFieldGenerator(newGame->simulation, fieldGenerator);
+    
+    if (appContext->replayRecordPath != NULL)
+    {
+        finishRecordingReplay(appContext);
+        appContext->replayRecorder = createReplayRecorder((uint8_t)mode, seed, (uint16_t)newGame->tickRate);
+    }
     
-    generateCubePositions(newGame, 1);
+    startSimulationThread(appContext, newGame);
     
     ZGAppSetAllowsScreenIdling(false);
 }
@@ -613,6 +994,8 @@ static void handleKeyboardEvent(ZGKeyboardEvent event, void *context)
     {
         case ZGKeyboardEventTypeKeyDown:
         {
+            appContext->sceneIsDirty = true;
+            
             GameSeries *gameSeries = appContext->gameSeries;
             if (gameSeries == NULL)
             {
@@ -741,6 +1124,9 @@ static void handleKeyboardEvent(ZGKeyboardEvent event, void *context)
         case ZGKeyboardEventTypeTextInput:
             break;
     }
+    
+    // Text input events don't carry a timestamp
+    publishGameInput(appContext, (event.type != ZGKeyboardEventTypeTextInput) ? event.timestamp : 0);
 }
 
 static void pollEventHandler(void *context, void *systemEvent)
@@ -749,6 +1135,11 @@ static void pollEventHandler(void *context, void *systemEvent)
     
     uint16_t gamepadEventsCount = 0;
     GamepadEvent *gamepadEvents = pollGamepadEvents(appContext->gamepadManager, systemEvent, &gamepadEventsCount);
+    if (gamepadEventsCount > 0)
+    {
+        appContext->sceneIsDirty = true;
+    }
+    
     for (uint16_t gamepadEventIndex = 0; gamepadEventIndex < gamepadEventsCount; gamepadEventIndex++)
     {
         GameSeries *gameSeries = appContext->gameSeries;
@@ -900,6 +1291,9 @@ static void pollEventHandler(void *context, void *systemEvent)
                 }
                 break;
         }
+        
+        // Each event is handed over on its own so the simulation knows when it happened
+        publishGameInput(appContext, gamepadEvent->ticks);
     }
 }
 
@@ -908,80 +1302,145 @@ static void runLoopHandler(void *context)
     AppContext *appContext = context;
     Renderer *renderer = &appContext->renderer;
     
-    // Update game state
-    // http://ludobloom.com/tutorials/timestep.html
-    
-    double currentTime = (double)ZGGetTicks() / 1000.0;
-    
-    double updateIterations = ((currentTime - appContext->lastFrameTime) + appContext->cyclesLeftOver);
-    
-    if (updateIterations > MAX_ITERATIONS)
+    // Pick up the newest state from the simulation thread
+    GameSeries *gameSeries = appContext->gameSeries;
+    if (gameSeries != NULL)
     {
-        updateIterations = MAX_ITERATIONS;
+        Game *game = gameSeries->game;
+        const GameSnapshot *snapshot = readTripleBuffer(game->snapshots, NULL);
+        game->snapshot = snapshot;
+        
+        if (snapshot->playerLost && !game->playerLost)
+        {
+            game->playerLost = true;
+            if (snapshot->score > appContext->highScore)
+            {
+                appContext->highScore = snapshot->score;
+            }
+            
+            gameSeries->numberOfGamesPlayed++;
+            
+            ZGAppSetAllowsScreenIdling(true);
+        }
+        
+        // A game that isn't stepping stays at its latest step
+        if (snapshot->paused || snapshot->playerLost)
+        {
+            appContext->interpolationFactor = 1.0f;
+        }
+        else
+        {
+            uint64_t nanoTicks = ZGGetNanoTicks();
+            double stepProgress = (nanoTicks > snapshot->stepNanoTicks) ? (double)(nanoTicks - snapshot->stepNanoTicks) / (double)snapshot->stepIntervalNanoseconds : 0.0;
+            appContext->interpolationFactor = (stepProgress < 1.0) ? (ZGFloat)stepProgress : 1.0f;
+        }
     }
     
-    while (updateIterations > ANIMATION_TIMER_INTERVAL)
+    bool sceneIsIdle = isSceneIdle(appContext);
+    if (sceneIsIdle != appContext->sceneIsIdle)
     {
-        updateIterations -= ANIMATION_TIMER_INTERVAL;
-        
-        animate(ANIMATION_TIMER_INTERVAL, appContext);
+        appContext->sceneIsIdle = sceneIsIdle;
+        appContext->sceneIsDirty = true;
     }
     
-    appContext->cyclesLeftOver = updateIterations;
-    appContext->lastFrameTime = currentTime;
+    // Strings being rasterized show up on the first draw after they finish
+    bool textIsRasterizing = isRasterizingText();
+    if (textIsRasterizing || appContext->textWasRasterizing)
+    {
+        appContext->sceneIsDirty = true;
+    }
+    appContext->textWasRasterizing = textIsRasterizing;
     
-    if (appContext->needsToDrawScene)
+    bool renderedFrame = appContext->needsToDrawScene && (!sceneIsIdle || appContext->sceneIsDirty);
+    if (renderedFrame)
     {
         renderFrame(renderer, drawScene, context);
+        appContext->sceneIsDirty = false;
     }
     
-    bool shouldCapFPS = !appContext->needsToDrawScene || !renderer->vsync;
+    // Block for events instead of spinning when nothing will change on screen until then
+    ZGAppSetWaitsForEvents((sceneIsIdle || !appContext->needsToDrawScene) && !appContext->sceneIsDirty);
+    
+    bool shouldCapFPS = !renderedFrame || !renderer->vsync;
     if (shouldCapFPS)
     {
-        uint32_t timeAfterRender = ZGGetTicks();
-        
-        if (appContext->lastRunloopTime > 0 && timeAfterRender > appContext->lastRunloopTime)
-        {
-            uint32_t timeElapsed = timeAfterRender - appContext->lastRunloopTime;
-            uint32_t targetTime = (uint32_t)(1000.0 / MAX_FPS_RATE);
-            
-            if (timeElapsed < targetTime)
-            {
-                ZGDelay(targetTime - timeElapsed);
-            }
-        }
-        
-        appContext->lastRunloopTime = ZGGetTicks();
+        paceFrame(&appContext->framePacer, (uint64_t)(1000000000.0 / MAX_FPS_RATE));
     }
 }
 
+// Loading the font and rasterizing the glyph atlas don't need the renderer, so they overlap its creation
+static void loadFontJob(void *context)
+{
+    initFontWithName(FONT_SYSTEM_NAME, FONT_POINT_SIZE);
+    markLaunchPhase("font loading (worker)");
+    
+#if RENDERER_CAN_DRAW_TEXTURE_QUADS
+    prepareGlyphAtlas();
+    markLaunchPhase("glyph atlas rasterization (worker)");
+#endif
+}
+
+// Scanning for connected gamepads (and their mapping database) doesn't need the window either
+static void initGamepadManagerJob(void *context)
+{
+    AppContext *appContext = context;
+    
+    appContext->gamepadManager = initGamepadManager(NULL, NULL, NULL, NULL);
+    markLaunchPhase("gamepad manager (worker)");
+}
+
 static ZGWindow *appLaunchedHandler(void *context)
 {
     AppContext *appContext = context;
     
-    mt_init();
+    markLaunchPhase("platform initialization");
+    
+    initJobSystem(0);
+    
+    JobCounter fontJobs = {0};
+    submitJob(loadFontJob, NULL, &fontJobs);
+    
+    JobCounter gamepadJobs = {0};
+    submitJob(initGamepadManagerJob, appContext, &gamepadJobs);
+    
+    mt_seed(&appContext->gameSeedState, (uint32_t)time(NULL));
+    
+    appContext->replayRecordPath = getenv(RECORD_REPLAY_ENVIRONMENT_VARIABLE);
+    appContext->replayPlayPath = getenv(PLAY_REPLAY_ENVIRONMENT_VARIABLE);
+    
+    const char *replaySpeedString = getenv(REPLAY_SPEED_ENVIRONMENT_VARIABLE);
+    double replaySpeed = (replaySpeedString != NULL) ? atof(replaySpeedString) : 1.0;
+    appContext->replaySpeed = (replaySpeed > 0.0) ? replaySpeed : 1.0;
     
     appContext->playOptionSelected = true;
     
-    appContext->lastRunloopTime = 0;
-    appContext->lastFrameTime = 0.0;
-    appContext->cyclesLeftOver = 0.0;
+    initFramePacer(&appContext->framePacer);
     appContext->needsToDrawScene = true;
     
+    markLaunchPhase("launch setup");
+    
     Defaults userDefaults = userDefaultsForReading(USER_DEFAULTS_NAME);
 
     appContext->highScore = (uint32_t)readDefaultIntKey(userDefaults, HIGH_SCORE_USER_DEFAULTS_KEY, 0);
     bool fullscreen = readDefaultBoolKey(userDefaults, FULLSCREEN_USER_DEFAULTS_KEY, false);
+    appContext->endlessMode = readDefaultBoolKey(userDefaults, ENDLESS_MODE_USER_DEFAULTS_KEY, false);
     int windowWidth = readDefaultIntKey(userDefaults, WINDOW_WIDTH_USER_DEFAULTS_KEY, 800);
     int windowHeight = readDefaultIntKey(userDefaults, WINDOW_HEIGHT_USER_DEFAULTS_KEY, 500);
     
-    closeDefaults(userDefaults);
+    int tickRate = readDefaultIntKey(userDefaults, TICK_RATE_USER_DEFAULTS_KEY, SIMULATION_DEFAULT_TICK_RATE);
+    if (tickRate > 0 && isSupportedSimulationTickRate((uint32_t)tickRate))
+    {
+        appContext->tickRate = (uint32_t)tickRate;
+    }
+    else
+    {
+        fprintf(stderr, "Error: unsupported tick rate %d, expected 60, 120, 240 or 480\n", tickRate);
+        appContext->tickRate = SIMULATION_DEFAULT_TICK_RATE;
+    }
     
-    ZGFloat playerDiagonalDistance = sqrtf((PLAYER_MAGNITUDE * PLAYER_MAGNITUDE) + (PLAYER_MAGNITUDE * PLAYER_MAGNITUDE));
-    ZGFloat cubeDiagonalDistance = sqrtf((CUBE_MAGNITUDE * CUBE_MAGNITUDE) + (CUBE_MAGNITUDE * CUBE_MAGNITUDE));
-    appContext->playerCubeDiagonalSumDistance = playerDiagonalDistance + cubeDiagonalDistance;
+    closeDefaults(userDefaults);
     
-    appContext->gamepadManager = initGamepadManager(NULL, NULL, NULL, NULL);
+    markLaunchPhase("reading user defaults");
     
     Renderer *renderer = &appContext->renderer;
     
@@ -989,6 +1448,7 @@ static ZGWindow *appLaunchedHandler(void *context)
     
     rendererOptions.clearColor = (color4_t){0.4f, 0.4f, 0.4f, 1.0f};
     rendererOptions.windowTitle = WINDOW_TITLE;
+    rendererOptions.programCacheDefaultsName = USER_DEFAULTS_NAME;
     rendererOptions.windowWidth = windowWidth;
     rendererOptions.windowHeight = windowHeight;
     rendererOptions.fullscreen = fullscreen;
@@ -1002,6 +1462,8 @@ static ZGWindow *appLaunchedHandler(void *context)
 
     createRenderer(renderer, rendererOptions);
     
+    markLaunchPhase("renderer creation");
+    
     // Create vertex/index data for our cubes
     {
         const ZGFloat vertices[] =
@@ -1114,18 +1576,59 @@ static ZGWindow *appLaunchedHandler(void *context)
         };
         
         appContext->cubeVertexArrayObject = createVertexArrayObject(renderer, vertices, sizeof(vertices));
+        
+        // Make sure obstacle cubes don't quite touch each other from rendering perspective
+        // The scaling is baked into the vertices because instanced cubes share a single model-view matrix
+        {
+            ZGFloat obstacleVertices[sizeof(vertices) / sizeof(vertices[0])];
+            for (uint32_t vertexComponentIndex = 0; vertexComponentIndex < sizeof(vertices) / sizeof(vertices[0]); vertexComponentIndex++)
+            {
+                obstacleVertices[vertexComponentIndex] = (vertexComponentIndex % 4 == 0) ? vertices[vertexComponentIndex] * 0.99f : vertices[vertexComponentIndex];
+            }
+            
+            appContext->cubeObstacleVertexArrayObject = createVertexArrayObject(renderer, obstacleVertices, sizeof(obstacleVertices));
+        }
+        
         appContext->cubeIndicesBufferObject = createIndexBufferObject(renderer, indices, sizeof(indices));
         appContext->cubeLineIndicesBufferObject = createIndexBufferObject(renderer, lineIndices, sizeof(lineIndices));
+        
+        appContext->cubeInstances = calloc(MAX_CUBE_COUNT, sizeof(*appContext->cubeInstances));
     }
     
-    initFontWithName(FONT_SYSTEM_NAME, FONT_POINT_SIZE);
-    initText(renderer, TEXT_RENDERING_CACHE_COUNT);
+    markLaunchPhase("cube buffers");
+    
+    waitForJobs(&fontJobs);
+    
+    markLaunchPhase("waiting for font loading");
+    
+    waitForJobs(&gamepadJobs);
+    
+    markLaunchPhase("waiting for gamepad manager");
+    
+    initText(renderer, TEXT_RENDERING_CACHE_BYTE_BUDGET);
+    
+    markLaunchPhase("text initialization");
+    
+    // Menu strings are shown again and again so keep them around
+    const char *pinnedStrings[] = {"Dodge Danger", "Play", "Quit", "Dodge!", "Play Again", "Exit", "Resume"};
+    for (size_t pinnedStringIndex = 0; pinnedStringIndex < sizeof(pinnedStrings) / sizeof(*pinnedStrings); pinnedStringIndex++)
+    {
+        pinString(renderer, pinnedStrings[pinnedStringIndex]);
+    }
+    
+    // Rasterize them during launch rather than on first use, along with the first score label
+    prewarmStrings(renderer, pinnedStrings, sizeof(pinnedStrings) / sizeof(*pinnedStrings));
+    prewarmStrings(renderer, (const char *[]){"Score: 0"}, 1);
+    
+    markLaunchPhase("string prewarming");
     
     return renderer->window;
 }
 
 int main(int argc, char *argv[])
 {
+    beginLaunchProfile();
+    
     static AppContext appContext;
 
     ZGAppHandlers appHandlers = {.launchedHandler = appLaunchedHandler, .terminatedHandler = appTerminatedHandler, .runLoopHandler = runLoopHandler, .pollEventHandler = pollEventHandler};
@@ -0,0 +1,221 @@
+/*
+ MIT License
+
+ Copyright (c) 2024 Mayur Pawashe
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+// Stress tests the SPSC and MPSC ring queues and reports their throughput
+// Build from src/ with "make queuebench", or with:
+//   cc -O2 -Iscengine queuebench.c scengine/ring_queue.c scengine/thread_posix.c -lpthread -o queuebench
+// Usage:
+//   queuebench [--count N] [--capacity C]
+// Pushes N elements through an SPSC queue from one producer, then through an MPSC queue from
+// MPSC_PRODUCER_COUNT producers. The consumer checks that each producer's elements arrive exactly
+// once and in the order they were pushed. Small capacities keep the queues full, which stresses wrapping around
+
+#include "ring_queue.h"
+#include "thread.h"
+#include "quit.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define DEFAULT_ELEMENT_COUNT 2000000
+#define DEFAULT_QUEUE_CAPACITY 1024
+#define MPSC_PRODUCER_COUNT 4
+// Give up the processor after this many failed attempts in a row, in case there are fewer cores than threads
+#define MAX_SPIN_COUNT 256
+
+typedef struct
+{
+    uint32_t producerIndex;
+    uint32_t sequence;
+} QueueElement;
+
+typedef struct
+{
+    SPSCQueue *spscQueue;
+    MPSCQueue *mpscQueue;
+    uint32_t producerIndex;
+    uint32_t elementCount;
+} Producer;
+
+// thread_posix.c quits through this when a thread or lock can't be created
+void ZGQuit(void)
+{
+    exit(EXIT_FAILURE);
+}
+
+static double currentWallTime(void)
+{
+    struct timespec timeSpec;
+    timespec_get(&timeSpec, TIME_UTC);
+    return (double)timeSpec.tv_sec + (double)timeSpec.tv_nsec / 1e9;
+}
+
+static void backOff(uint32_t *spinCount)
+{
+    (*spinCount)++;
+    if (*spinCount >= MAX_SPIN_COUNT)
+    {
+        ZGDelay(0);
+        *spinCount = 0;
+    }
+}
+
+static int producerThread(void *context)
+{
+    Producer *producer = context;
+    uint32_t spinCount = 0;
+    for (uint32_t sequence = 0; sequence < producer->elementCount; sequence++)
+    {
+        QueueElement element;
+        element.producerIndex = producer->producerIndex;
+        element.sequence = sequence;
+        while (!((producer->spscQueue != NULL) ? pushSPSCQueue(producer->spscQueue, &element) : pushMPSCQueue(producer->mpscQueue, &element)))
+        {
+            backOff(&spinCount);
+        }
+    }
+    return 0;
+}
+
+// Runs the producers on their own threads and consumes on this one; returns false if anything arrived out of order
+static bool runQueueTest(const char *name, SPSCQueue *spscQueue, MPSCQueue *mpscQueue, uint32_t producerCount, uint32_t elementCount)
+{
+    Producer producers[MPSC_PRODUCER_COUNT];
+    ZGThread producerThreads[MPSC_PRODUCER_COUNT];
+    uint32_t nextSequences[MPSC_PRODUCER_COUNT] = {0};
+    
+    double startTime = currentWallTime();
+    
+    uint32_t totalElementCount = 0;
+    for (uint32_t producerIndex = 0; producerIndex < producerCount; producerIndex++)
+    {
+        Producer *producer = &producers[producerIndex];
+        producer->spscQueue = spscQueue;
+        producer->mpscQueue = mpscQueue;
+        producer->producerIndex = producerIndex;
+        // The first producer takes whatever doesn't divide evenly
+        producer->elementCount = elementCount / producerCount + ((producerIndex == 0) ? elementCount % producerCount : 0);
+        totalElementCount += producer->elementCount;
+        
+        producerThreads[producerIndex] = ZGCreateThread(producerThread, "producer", producer);
+    }
+    
+    bool passed = true;
+    uint32_t spinCount = 0;
+    for (uint32_t receivedCount = 0; receivedCount < totalElementCount && passed;)
+    {
+        QueueElement element;
+        if (!((spscQueue != NULL) ? popSPSCQueue(spscQueue, &element) : popMPSCQueue(mpscQueue, &element)))
+        {
+            backOff(&spinCount);
+            continue;
+        }
+        
+        if (element.producerIndex >= producerCount)
+        {
+            fprintf(stderr, "Error: %s received an element from unknown producer %u\n", name, element.producerIndex);
+            passed = false;
+        }
+        else if (element.sequence != nextSequences[element.producerIndex])
+        {
+            fprintf(stderr, "Error: %s received element %u from producer %u but expected %u\n", name, element.sequence, element.producerIndex, nextSequences[element.producerIndex]);
+            passed = false;
+        }
+        else
+        {
+            nextSequences[element.producerIndex]++;
+            receivedCount++;
+        }
+    }
+    
+    // After a failure, keep draining so that producers waiting on a full queue can finish
+    for (uint32_t producerIndex = 0; producerIndex < producerCount; producerIndex++)
+    {
+        if (!passed)
+        {
+            QueueElement element;
+            while ((spscQueue != NULL) ? popSPSCQueue(spscQueue, &element) : popMPSCQueue(mpscQueue, &element))
+            {
+            }
+        }
+        ZGWaitThread(producerThreads[producerIndex]);
+    }
+    
+    double elapsedTime = currentWallTime() - startTime;
+    
+    QueueElement extraElement;
+    if (passed && ((spscQueue != NULL) ? popSPSCQueue(spscQueue, &extraElement) : popMPSCQueue(mpscQueue, &extraElement)))
+    {
+        fprintf(stderr, "Error: %s had an element left over after every element was received\n", name);
+        passed = false;
+    }
+    
+    if (passed)
+    {
+        printf("%s: %u producer(s), %u elements in order, %.3f s, %.2f million elements/sec\n", name, producerCount, totalElementCount, elapsedTime, (elapsedTime > 0.0) ? totalElementCount / elapsedTime / 1e6 : 0.0);
+    }
+    return passed;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t elementCount = DEFAULT_ELEMENT_COUNT;
+    uint32_t capacity = DEFAULT_QUEUE_CAPACITY;
+    
+    for (int argumentIndex = 1; argumentIndex < argc; argumentIndex++)
+    {
+        const char *argument = argv[argumentIndex];
+        if (strcmp(argument, "--count") == 0 && argumentIndex + 1 < argc)
+        {
+            elementCount = (uint32_t)strtoul(argv[++argumentIndex], NULL, 10);
+        }
+        else if (strcmp(argument, "--capacity") == 0 && argumentIndex + 1 < argc)
+        {
+            capacity = (uint32_t)strtoul(argv[++argumentIndex], NULL, 10);
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [--count N] [--capacity C]\n", argv[0]);
+            return 1;
+        }
+    }
+    
+    SPSCQueue *spscQueue = createSPSCQueue(capacity, sizeof(QueueElement));
+    MPSCQueue *mpscQueue = createMPSCQueue(capacity, sizeof(QueueElement));
+    if (spscQueue == NULL || mpscQueue == NULL)
+    {
+        fprintf(stderr, "Error: failed to create queues with capacity %u\n", capacity);
+        return 1;
+    }
+    
+    bool passed = runQueueTest("spsc", spscQueue, NULL, 1, elementCount);
+    passed = runQueueTest("mpsc", NULL, mpscQueue, MPSC_PRODUCER_COUNT, elementCount) && passed;
+    
+    destroySPSCQueue(spscQueue);
+    destroyMPSCQueue(mpscQueue);
+    
+    return passed ? 0 : 1;
+}
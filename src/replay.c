@@ -0,0 +1,358 @@
+/*
+ MIT License
+
+ Copyright (c) 2024 Mayur Pawashe
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#include "replay.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REPLAY_MAGIC "DDRP"
+#define REPLAY_VERSION 1
+#define REPLAY_HEADER_SIZE 12
+#define REPLAY_EVENT_END 0xFF
+
+struct _ReplayRecorder
+{
+    uint8_t *data;
+    size_t size;
+    size_t capacity;
+    
+    uint64_t tick;
+    uint64_t lastEventTick;
+    uint8_t lastInputState;
+};
+
+struct _ReplayPlayer
+{
+    uint8_t *data;
+    size_t size;
+    size_t offset;
+    
+    uint8_t gameMode;
+    uint32_t seed;
+    uint16_t tickRate;
+    
+    uint64_t tick;
+    uint64_t nextEventTick;
+    uint8_t nextEventState;
+    uint8_t nextEventSubdivision;
+    uint8_t inputState;
+};
+
+static void appendReplayByte(ReplayRecorder *recorder, uint8_t byte)
+{
+    if (recorder->size == recorder->capacity)
+    {
+        recorder->capacity *= 2;
+        recorder->data = realloc(recorder->data, recorder->capacity);
+        if (recorder->data == NULL)
+        {
+            fprintf(stderr, "Error: failed to grow replay buffer\n");
+            abort();
+        }
+    }
+    
+    recorder->data[recorder->size++] = byte;
+}
+
+static void appendReplayVarint(ReplayRecorder *recorder, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        appendReplayByte(recorder, (uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    appendReplayByte(recorder, (uint8_t)value);
+}
+
+ReplayRecorder *createReplayRecorder(uint8_t gameMode, uint32_t seed, uint16_t tickRate)
+{
+    ReplayRecorder *recorder = calloc(1, sizeof(*recorder));
+    recorder->capacity = 1024;
+    recorder->data = malloc(recorder->capacity);
+    
+    for (size_t magicIndex = 0; magicIndex < 4; magicIndex++)
+    {
+        appendReplayByte(recorder, (uint8_t)REPLAY_MAGIC[magicIndex]);
+    }
+    appendReplayByte(recorder, REPLAY_VERSION);
+    appendReplayByte(recorder, gameMode);
+    for (uint32_t byteIndex = 0; byteIndex < 4; byteIndex++)
+    {
+        appendReplayByte(recorder, (uint8_t)(seed >> (8 * byteIndex)));
+    }
+    appendReplayByte(recorder, (uint8_t)tickRate);
+    appendReplayByte(recorder, (uint8_t)(tickRate >> 8));
+    
+    return recorder;
+}
+
+static void recordReplayEvent(ReplayRecorder *recorder, uint8_t inputState, uint8_t subdivision)
+{
+    if (inputState != recorder->lastInputState)
+    {
+        appendReplayVarint(recorder, recorder->tick - recorder->lastEventTick);
+        appendReplayByte(recorder, inputState);
+        appendReplayByte(recorder, subdivision);
+        
+        recorder->lastEventTick = recorder->tick;
+        recorder->lastInputState = inputState;
+    }
+}
+
+void recordReplayTick(ReplayRecorder *recorder, uint8_t inputState)
+{
+    recordReplayTickWithInputChanges(recorder, inputState, NULL, 0);
+}
+
+void recordReplayTickWithInputChanges(ReplayRecorder *recorder, uint8_t inputState, const ReplayInputChange *changes, uint32_t changeCount)
+{
+    recordReplayEvent(recorder, inputState, 0);
+    for (uint32_t changeIndex = 0; changeIndex < changeCount; changeIndex++)
+    {
+        recordReplayEvent(recorder, changes[changeIndex].inputState, changes[changeIndex].subdivision);
+    }
+    
+    recorder->tick++;
+}
+
+bool writeReplay(const ReplayRecorder *recorder, const char *path)
+{
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Error: failed to open replay %s for writing\n", path);
+        return false;
+    }
+    
+    // The end marker is written separately so recording can keep going after a snapshot is saved
+    uint8_t endBytes[11];
+    size_t endSize = 0;
+    uint64_t remainingTicks = recorder->tick - recorder->lastEventTick;
+    while (remainingTicks >= 0x80)
+    {
+        endBytes[endSize++] = (uint8_t)(remainingTicks | 0x80);
+        remainingTicks >>= 7;
+    }
+    endBytes[endSize++] = (uint8_t)remainingTicks;
+    endBytes[endSize++] = REPLAY_EVENT_END;
+    
+    bool success = (fwrite(recorder->data, 1, recorder->size, file) == recorder->size) && (fwrite(endBytes, 1, endSize, file) == endSize);
+    if (fclose(file) != 0)
+    {
+        success = false;
+    }
+    
+    if (!success)
+    {
+        fprintf(stderr, "Error: failed to write replay %s\n", path);
+    }
+    
+    return success;
+}
+
+void destroyReplayRecorder(ReplayRecorder *recorder)
+{
+    free(recorder->data);
+    free(recorder);
+}
+
+static bool readReplayVarint(ReplayPlayer *player, uint64_t *value)
+{
+    uint64_t result = 0;
+    for (uint32_t shift = 0; shift < 64; shift += 7)
+    {
+        if (player->offset >= player->size)
+        {
+            return false;
+        }
+        
+        uint8_t byte = player->data[player->offset++];
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Reads the next event into nextEventTick, nextEventState and nextEventSubdivision
+static bool readNextReplayEvent(ReplayPlayer *player)
+{
+    uint64_t tickDelta;
+    if (!readReplayVarint(player, &tickDelta) || player->offset >= player->size)
+    {
+        return false;
+    }
+    
+    player->nextEventTick += tickDelta;
+    player->nextEventState = player->data[player->offset++];
+    player->nextEventSubdivision = 0;
+    
+    // The end marker has no subdivision
+    if (player->nextEventState != REPLAY_EVENT_END)
+    {
+        if (player->offset >= player->size)
+        {
+            return false;
+        }
+        player->nextEventSubdivision = player->data[player->offset++];
+    }
+    return true;
+}
+
+ReplayPlayer *loadReplay(const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Error: failed to open replay %s\n", path);
+        return NULL;
+    }
+    
+    size_t capacity = 4096;
+    size_t size = 0;
+    uint8_t *data = malloc(capacity);
+    while (data != NULL)
+    {
+        size_t readCount = fread(data + size, 1, capacity - size, file);
+        size += readCount;
+        if (size < capacity)
+        {
+            break;
+        }
+        
+        capacity *= 2;
+        uint8_t *grownData = realloc(data, capacity);
+        if (grownData == NULL)
+        {
+            free(data);
+        }
+        data = grownData;
+    }
+    fclose(file);
+    
+    if (data == NULL)
+    {
+        fprintf(stderr, "Error: failed to allocate buffer for replay %s\n", path);
+        return NULL;
+    }
+    
+    if (size < REPLAY_HEADER_SIZE || memcmp(data, REPLAY_MAGIC, 4) != 0 || data[4] != REPLAY_VERSION)
+    {
+        fprintf(stderr, "Error: %s is not a supported replay\n", path);
+        free(data);
+        return NULL;
+    }
+    
+    ReplayPlayer *player = calloc(1, sizeof(*player));
+    player->data = data;
+    player->size = size;
+    player->offset = REPLAY_HEADER_SIZE;
+    player->gameMode = data[5];
+    player->seed = (uint32_t)data[6] | ((uint32_t)data[7] << 8) | ((uint32_t)data[8] << 16) | ((uint32_t)data[9] << 24);
+    player->tickRate = (uint16_t)(data[10] | (data[11] << 8));
+    
+    if (!readNextReplayEvent(player))
+    {
+        fprintf(stderr, "Error: replay %s is truncated\n", path);
+        destroyReplayPlayer(player);
+        return NULL;
+    }
+    
+    return player;
+}
+
+uint8_t replayGameMode(const ReplayPlayer *player)
+{
+    return player->gameMode;
+}
+
+uint32_t replaySeed(const ReplayPlayer *player)
+{
+    return player->seed;
+}
+
+uint16_t replayTickRate(const ReplayPlayer *player)
+{
+    return player->tickRate;
+}
+
+bool nextReplayTick(ReplayPlayer *player, uint8_t *inputState)
+{
+    ReplayInputChange changes[REPLAY_MAX_TICK_INPUT_CHANGES];
+    uint32_t changeCount;
+    return nextReplayTickWithInputChanges(player, inputState, changes, &changeCount);
+}
+
+bool nextReplayTickWithInputChanges(ReplayPlayer *player, uint8_t *inputState, ReplayInputChange *changes, uint32_t *changeCount)
+{
+    *changeCount = 0;
+    
+    uint8_t tickInputState = player->inputState;
+    while (player->tick == player->nextEventTick)
+    {
+        if (player->nextEventState == REPLAY_EVENT_END)
+        {
+            return false;
+        }
+        
+        if (player->nextEventSubdivision == 0 && *changeCount == 0)
+        {
+            tickInputState = player->nextEventState;
+        }
+        else if (*changeCount < REPLAY_MAX_TICK_INPUT_CHANGES)
+        {
+            changes[*changeCount].inputState = player->nextEventState;
+            changes[*changeCount].subdivision = player->nextEventSubdivision;
+            (*changeCount)++;
+        }
+        else
+        {
+            // Recorders never store more changes than this, so this only guards against corrupt replays
+            changes[*changeCount - 1].inputState = player->nextEventState;
+        }
+        
+        player->inputState = player->nextEventState;
+        if (!readNextReplayEvent(player))
+        {
+            fprintf(stderr, "Error: replay ended without an end marker\n");
+            player->nextEventState = REPLAY_EVENT_END;
+            return false;
+        }
+    }
+    
+    player->tick++;
+    *inputState = tickInputState;
+    return true;
+}
+
+void destroyReplayPlayer(ReplayPlayer *player)
+{
+    free(player->data);
+    free(player);
+}
@@ -0,0 +1,83 @@
+/*
+ MIT License
+
+ Copyright (c) 2024 Mayur Pawashe
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Replays store a game's seed and the tick, and point within the tick, at which its input state changes
+// Format (little endian):
+//   "DDRP" magic, uint8 version (1), uint8 game mode, uint32 seed, uint16 ticks per second
+//   events: varint ticks since previous event, uint8 input state, uint8 tick subdivision
+//   end: varint ticks since previous event, REPLAY_EVENT_END
+
+#define REPLAY_INPUT_LEFT 0x1
+#define REPLAY_INPUT_RIGHT 0x2
+#define REPLAY_INPUT_PAUSED 0x4
+
+// Changes partway through a tick are stored in units of 1/REPLAY_TICK_SUBDIVISIONS of a tick
+#define REPLAY_TICK_SUBDIVISIONS 256
+#define REPLAY_MAX_TICK_INPUT_CHANGES 8
+
+typedef struct
+{
+    uint8_t inputState;
+    // In [1, REPLAY_TICK_SUBDIVISIONS); changes at the start of a tick are part of the tick's input state instead
+    uint8_t subdivision;
+} ReplayInputChange;
+
+typedef struct _ReplayRecorder ReplayRecorder;
+typedef struct _ReplayPlayer ReplayPlayer;
+
+ReplayRecorder *createReplayRecorder(uint8_t gameMode, uint32_t seed, uint16_t tickRate);
+
+// Must be called exactly once per fixed animation tick with the input state for that tick
+void recordReplayTick(ReplayRecorder *recorder, uint8_t inputState);
+
+// Like recordReplayTick() for a tick that starts with inputState and then changes, with changes in nondecreasing subdivision
+// Each change must differ from the state before it, since changes that don't are dropped and would not play back
+void recordReplayTickWithInputChanges(ReplayRecorder *recorder, uint8_t inputState, const ReplayInputChange *changes, uint32_t changeCount);
+
+bool writeReplay(const ReplayRecorder *recorder, const char *path);
+
+void destroyReplayRecorder(ReplayRecorder *recorder);
+
+// Returns NULL if the replay cannot be read or is not valid
+ReplayPlayer *loadReplay(const char *path);
+
+uint8_t replayGameMode(const ReplayPlayer *player);
+uint32_t replaySeed(const ReplayPlayer *player);
+// The ticks per second the replay was recorded at, which it must be played back at
+uint16_t replayTickRate(const ReplayPlayer *player);
+
+// Retrieves the input state for the next tick. Returns false once the recorded ticks run out
+// Changes partway through the tick are applied to the following tick's input state
+bool nextReplayTick(ReplayPlayer *player, uint8_t *inputState);
+
+// Like nextReplayTick() but also retrieves the changes partway through the tick
+// changes must have room for REPLAY_MAX_TICK_INPUT_CHANGES
+bool nextReplayTickWithInputChanges(ReplayPlayer *player, uint8_t *inputState, ReplayInputChange *changes, uint32_t *changeCount);
+
+void destroyReplayPlayer(ReplayPlayer *player);
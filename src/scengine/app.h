@@ -38,3 +38,7 @@ typedef struct
 int ZGAppInit(int argc, char *argv[], ZGAppHandlers *appHandlers, void *appContext);
 
 void ZGAppSetAllowsScreenIdling(bool allowsScreenIdling);
+
+// While enabled, the run loop blocks until an event arrives or a short timeout passes before calling runLoopHandler
+// Used to stop spinning while nothing on screen changes; platforms driven by the display may ignore it
+void ZGAppSetWaitsForEvents(bool waitsForEvents);
@@ -107,3 +107,8 @@ void ZGAppSetAllowsScreenIdling(bool allowsScreenIdling)
 	UIApplication *application = [UIApplication sharedApplication];
 	[application setIdleTimerDisabled:!allowsScreenIdling];
 }
+
+void ZGAppSetWaitsForEvents(bool waitsForEvents)
+{
+	// The run loop is already driven by the display, which doesn't spin
+}
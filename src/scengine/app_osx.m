@@ -154,3 +154,8 @@ void ZGAppSetAllowsScreenIdling(bool allowsScreenIdling)
 		}
 	}
 }
+
+void ZGAppSetWaitsForEvents(bool waitsForEvents)
+{
+	// The run loop is already driven by the display, which doesn't spin
+}
@@ -26,10 +26,16 @@
 
 #include "app.h"
 #include "quit.h"
+#include "launch_profile.h"
 
 #include <stdio.h>
 #include <stdbool.h>
 
+// Longest time to block waiting for events; nothing needs to happen sooner while waiting
+#define APP_EVENT_WAIT_TIMEOUT_MS 100
+
+static bool gWaitsForEvents;
+
 #if PLATFORM_LINUX
 #include <libgen.h>
 #include <unistd.h>
@@ -46,6 +52,8 @@ int ZGAppInit(int argc, char *argv[], ZGAppHandlers *appHandlers, void *appConte
 		fprintf(stderr, "Couldn't initialize SDL: %s\n", SDL_GetError());
 		ZGQuit();
 	}
+	
+	markLaunchPhase("SDL_Init");
 
 #if PLATFORM_LINUX && !_DEBUG
 	char basePath[PATH_MAX + 1] = {0};
@@ -91,7 +99,8 @@ int ZGAppInit(int argc, char *argv[], ZGAppHandlers *appHandlers, void *appConte
 	while (!done)
 	{
 		SDL_Event event;
-		while (SDL_PollEvent(&event))
+		bool hasEvent = gWaitsForEvents ? SDL_WaitEventTimeout(&event, APP_EVENT_WAIT_TIMEOUT_MS) : SDL_PollEvent(&event);
+		for (; hasEvent; hasEvent = SDL_PollEvent(&event))
 		{
 			switch (event.type)
 			{
@@ -138,3 +147,8 @@ void ZGAppSetAllowsScreenIdling(bool allowsScreenIdling)
 		}
 	}
 }
+
+void ZGAppSetWaitsForEvents(bool waitsForEvents)
+{
+	gWaitsForEvents = waitsForEvents;
+}
@@ -34,6 +34,11 @@
 
 #define MAX_EVENTS 10
 
+// Gamepads are polled rather than delivered as messages, so keep waking up often enough for menus to stay responsive
+#define APP_EVENT_WAIT_TIMEOUT_MS 16
+
+static bool gWaitsForEvents;
+
 extern int main(int argc, char* argv[]);
 
 INT WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPTSTR commandLine, int nCmdShow)
@@ -58,6 +63,11 @@ int ZGAppInit(int argc, char* argv[], ZGAppHandlers* appHandlers, void* appConte
 	
 	while (true)
 	{
+		if (gWaitsForEvents)
+		{
+			MsgWaitForMultipleObjects(0, NULL, FALSE, APP_EVENT_WAIT_TIMEOUT_MS, QS_ALLINPUT);
+		}
+		
 		int eventCount = 0;
 		MSG message;
 		while (PeekMessage(&message, NULL, 0, 0, PM_REMOVE) != 0)
@@ -98,3 +108,8 @@ void ZGAppSetAllowsScreenIdling(bool allowsScreenIdling)
 		SetThreadExecutionState(ES_CONTINUOUS | ES_DISPLAY_REQUIRED);
 	}
 }
+
+void ZGAppSetWaitsForEvents(bool waitsForEvents)
+{
+	gWaitsForEvents = waitsForEvents;
+}
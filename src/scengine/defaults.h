@@ -48,6 +48,11 @@ bool readDefaultBoolKey(Defaults defaults, const char *key, bool defaultValue);
 void writeDefaultIntKey(Defaults defaults, const char *key, int value);
 void writeDefaultStringKey(Defaults defaults, const char *key, const char *value);
 
+#if PLATFORM_LINUX
+// Opens fileName inside the user data directory for defaultsName, creating the directory if needed
+FILE *getUserDataFileWithName(const char *defaultsName, const char *fileName, const char *mode);
+#endif
+
 #if PLATFORM_OSX
 void getDefaultUserName(char *defaultUserName, int maxLength);
 #endif
@@ -31,7 +31,7 @@
  #include <ctype.h>
  #include <limits.h>
  
- FILE *getUserDataFile(const char *defaultsName, const char *mode)
+ FILE *getUserDataFileWithName(const char *defaultsName, const char *fileName, const char *mode)
  {
 	char dataDirectory[PATH_MAX + 1] = {0};
 
@@ -68,8 +68,14 @@
 	int success = mkdir(dataDirectory, 0777);
 	if (success == 0 || errno == EEXIST)
 	{
-		strncat(dataDirectory, "/user_data.txt", sizeof(dataDirectory) - 1 - strlen(dataDirectory));
+		strncat(dataDirectory, "/", sizeof(dataDirectory) - 1 - strlen(dataDirectory));
+		strncat(dataDirectory, fileName, sizeof(dataDirectory) - 1 - strlen(dataDirectory));
 		return fopen(dataDirectory, mode);
 	}
 	return NULL;
  }
+ 
+ FILE *getUserDataFile(const char *defaultsName, const char *mode)
+ {
+	return getUserDataFileWithName(defaultsName, "user_data.txt", mode);
+ }
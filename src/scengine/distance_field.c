@@ -0,0 +1,190 @@
+/*
+ MIT License
+
+ Copyright (c) 2024 Mayur Pawashe
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#include "distance_field.h"
+#include <stdlib.h>
+#include <math.h>
+#include <stdio.h>
+
+// Large enough to never be the nearest distance, small enough not to overflow when squared offsets are added
+#define DISTANCE_FIELD_FAR 1e20f
+
+// Squared Euclidean distance transform of a sampled function in one dimension
+// See "Distance Transforms of Sampled Functions" by Felzenszwalb and Huttenlocher
+static void distanceTransform1D(const float *samples, int32_t count, float *distances, int32_t *parabolaVertices, float *parabolaBoundaries)
+{
+	int32_t parabolaIndex = 0;
+	parabolaVertices[0] = 0;
+	parabolaBoundaries[0] = -DISTANCE_FIELD_FAR;
+	parabolaBoundaries[1] = DISTANCE_FIELD_FAR;
+	
+	for (int32_t sampleIndex = 1; sampleIndex < count; sampleIndex++)
+	{
+		float intersection;
+		while (true)
+		{
+			int32_t vertex = parabolaVertices[parabolaIndex];
+			intersection = ((samples[sampleIndex] + (float)sampleIndex * sampleIndex) - (samples[vertex] + (float)vertex * vertex)) / (2.0f * sampleIndex - 2.0f * vertex);
+			
+			if (intersection > parabolaBoundaries[parabolaIndex] || parabolaIndex == 0)
+			{
+				break;
+			}
+			parabolaIndex--;
+		}
+		
+		parabolaIndex++;
+		parabolaVertices[parabolaIndex] = sampleIndex;
+		parabolaBoundaries[parabolaIndex] = intersection;
+		parabolaBoundaries[parabolaIndex + 1] = DISTANCE_FIELD_FAR;
+	}
+	
+	parabolaIndex = 0;
+	for (int32_t sampleIndex = 0; sampleIndex < count; sampleIndex++)
+	{
+		while (parabolaBoundaries[parabolaIndex + 1] < sampleIndex)
+		{
+			parabolaIndex++;
+		}
+		
+		int32_t vertex = parabolaVertices[parabolaIndex];
+		float offset = (float)(sampleIndex - vertex);
+		distances[sampleIndex] = offset * offset + samples[vertex];
+	}
+}
+
+// Replaces each value in grid with the squared distance to the nearest zero valued cell
+static void distanceTransform2D(float *grid, int32_t width, int32_t height, float *samples, float *distances, int32_t *parabolaVertices, float *parabolaBoundaries)
+{
+	for (int32_t x = 0; x < width; x++)
+	{
+		for (int32_t y = 0; y < height; y++)
+		{
+			samples[y] = grid[y * width + x];
+		}
+		
+		distanceTransform1D(samples, height, distances, parabolaVertices, parabolaBoundaries);
+		
+		for (int32_t y = 0; y < height; y++)
+		{
+			grid[y * width + x] = distances[y];
+		}
+	}
+	
+	for (int32_t y = 0; y < height; y++)
+	{
+		distanceTransform1D(&grid[y * width], width, distances, parabolaVertices, parabolaBoundaries);
+		
+		for (int32_t x = 0; x < width; x++)
+		{
+			grid[y * width + x] = distances[x];
+		}
+	}
+}
+
+int32_t distanceFieldSize(int32_t bitmapSize, int32_t downsampleFactor, int32_t spread)
+{
+	return (bitmapSize + downsampleFactor - 1) / downsampleFactor + 2 * spread;
+}
+
+bool createDistanceField(const uint8_t *pixels, int32_t width, int32_t height, int32_t downsampleFactor, int32_t spread, uint8_t *distanceField)
+{
+	int32_t fieldWidth = distanceFieldSize(width, downsampleFactor, spread);
+	int32_t fieldHeight = distanceFieldSize(height, downsampleFactor, spread);
+	
+	// Distances are computed at the bitmap's resolution over the padded area covered by the field
+	int32_t gridWidth = fieldWidth * downsampleFactor;
+	int32_t gridHeight = fieldHeight * downsampleFactor;
+	int32_t padding = spread * downsampleFactor;
+	
+	size_t gridCount = (size_t)gridWidth * (size_t)gridHeight;
+	int32_t maxDimension = (gridWidth > gridHeight) ? gridWidth : gridHeight;
+	
+	float *insideDistances = malloc(gridCount * sizeof(*insideDistances));
+	float *outsideDistances = malloc(gridCount * sizeof(*outsideDistances));
+	float *samples = malloc((size_t)maxDimension * sizeof(*samples));
+	float *distances = malloc((size_t)maxDimension * sizeof(*distances));
+	int32_t *parabolaVertices = malloc((size_t)maxDimension * sizeof(*parabolaVertices));
+	float *parabolaBoundaries = malloc(((size_t)maxDimension + 1) * sizeof(*parabolaBoundaries));
+	
+	bool succeeded = (insideDistances != NULL && outsideDistances != NULL && samples != NULL && distances != NULL && parabolaVertices != NULL && parabolaBoundaries != NULL);
+	if (succeeded)
+	{
+		for (int32_t gridY = 0; gridY < gridHeight; gridY++)
+		{
+			for (int32_t gridX = 0; gridX < gridWidth; gridX++)
+			{
+				int32_t x = gridX - padding;
+				int32_t y = gridY - padding;
+				
+				bool inside = (x >= 0 && x < width && y >= 0 && y < height && pixels[((size_t)y * width + x) * 4 + 3] >= 128);
+				
+				size_t gridIndex = (size_t)gridY * gridWidth + gridX;
+				// Distance to the nearest pixel inside the glyph, and to the nearest pixel outside of it
+				insideDistances[gridIndex] = inside ? 0.0f : DISTANCE_FIELD_FAR;
+				outsideDistances[gridIndex] = inside ? DISTANCE_FIELD_FAR : 0.0f;
+			}
+		}
+		
+		distanceTransform2D(insideDistances, gridWidth, gridHeight, samples, distances, parabolaVertices, parabolaBoundaries);
+		distanceTransform2D(outsideDistances, gridWidth, gridHeight, samples, distances, parabolaVertices, parabolaBoundaries);
+		
+		for (int32_t fieldY = 0; fieldY < fieldHeight; fieldY++)
+		{
+			for (int32_t fieldX = 0; fieldX < fieldWidth; fieldX++)
+			{
+				// Sample the center of the bitmap pixels this texel covers
+				size_t gridIndex = (size_t)(fieldY * downsampleFactor + downsampleFactor / 2) * gridWidth + (size_t)(fieldX * downsampleFactor + downsampleFactor / 2);
+				
+				// Positive inside the glyph, in units of field texels
+				float signedDistance = (sqrtf(outsideDistances[gridIndex]) - sqrtf(insideDistances[gridIndex])) / downsampleFactor;
+				
+				float value = 128.0f + signedDistance * (127.0f / spread);
+				if (value < 0.0f)
+				{
+					value = 0.0f;
+				}
+				else if (value > 255.0f)
+				{
+					value = 255.0f;
+				}
+				
+				distanceField[fieldY * fieldWidth + fieldX] = (uint8_t)(value + 0.5f);
+			}
+		}
+	}
+	else
+	{
+		fprintf(stderr, "Error: failed to allocate memory for distance field\n");
+	}
+	
+	free(insideDistances);
+	free(outsideDistances);
+	free(samples);
+	free(distances);
+	free(parabolaVertices);
+	free(parabolaBoundaries);
+	
+	return succeeded;
+}
@@ -0,0 +1,37 @@
+/*
+ MIT License
+
+ Copyright (c) 2024 Mayur Pawashe
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Width or height of the distance field generated for a bitmap of bitmapSize pixels
+int32_t distanceFieldSize(int32_t bitmapSize, int32_t downsampleFactor, int32_t spread);
+
+// Writes a signed distance field for the alpha coverage of a width x height RGBA bitmap, one byte per texel
+// The field is downsampled by downsampleFactor and padded by spread texels on every side,
+// so it is distanceFieldSize(width, ...) x distanceFieldSize(height, ...) texels
+// 128 lies on the edge, and values fall to 0 outside and rise to 255 inside spread texels away
+bool createDistanceField(const uint8_t *pixels, int32_t width, int32_t height, int32_t downsampleFactor, int32_t spread, uint8_t *distanceField);
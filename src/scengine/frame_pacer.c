@@ -0,0 +1,108 @@
+/*
+ MIT License
+
+ Copyright (c) 2024 Mayur Pawashe
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#include "frame_pacer.h"
+#include "zgtime.h"
+#include "thread.h"
+
+#include <stdio.h>
+
+// Sleeping may overshoot, so stop sleeping this long before the deadline and spin the rest of the way
+#define FRAME_PACER_SPIN_NANOSECONDS 1000000
+// Short intervals spin for at most this fraction of each frame so fast rates don't keep a core busy
+#define FRAME_PACER_MAX_SPIN_FRACTION 8
+
+void initFramePacer(FramePacer *framePacer)
+{
+	framePacer->delayTimer = ZGCreateDelayTimer();
+	resetFramePacer(framePacer);
+}
+
+void destroyFramePacer(FramePacer *framePacer)
+{
+	ZGDestroyDelayTimer(framePacer->delayTimer);
+	framePacer->delayTimer = NULL;
+}
+
+void resetFramePacer(FramePacer *framePacer)
+{
+	framePacer->lastFrameNanoTicks = 0;
+}
+
+void paceFrame(FramePacer *framePacer, uint64_t frameIntervalNanoseconds)
+{
+	uint64_t nanoTicks = ZGGetNanoTicks();
+	uint64_t lastFrameNanoTicks = framePacer->lastFrameNanoTicks;
+	
+	if (lastFrameNanoTicks == 0 || nanoTicks < lastFrameNanoTicks || nanoTicks - lastFrameNanoTicks >= frameIntervalNanoseconds)
+	{
+		framePacer->lastFrameNanoTicks = nanoTicks;
+		return;
+	}
+	
+	uint64_t spinNanoseconds = frameIntervalNanoseconds / FRAME_PACER_MAX_SPIN_FRACTION;
+	if (spinNanoseconds > FRAME_PACER_SPIN_NANOSECONDS)
+	{
+		spinNanoseconds = FRAME_PACER_SPIN_NANOSECONDS;
+	}
+	
+	uint64_t deadlineNanoTicks = lastFrameNanoTicks + frameIntervalNanoseconds;
+	uint64_t remainingNanoseconds = deadlineNanoTicks - nanoTicks;
+	if (remainingNanoseconds > spinNanoseconds)
+	{
+		ZGDelayNanoseconds(framePacer->delayTimer, remainingNanoseconds - spinNanoseconds);
+	}
+	
+	uint64_t spinStartNanoTicks = ZGGetNanoTicks();
+	do
+	{
+		nanoTicks = ZGGetNanoTicks();
+	}
+	while (nanoTicks < deadlineNanoTicks);
+	
+	FramePacerStatistics *statistics = &framePacer->statistics;
+	uint64_t errorNanoseconds = nanoTicks - deadlineNanoTicks;
+	statistics->pacedFrameCount++;
+	statistics->totalErrorNanoseconds += errorNanoseconds;
+	if (errorNanoseconds > statistics->maxErrorNanoseconds)
+	{
+		statistics->maxErrorNanoseconds = errorNanoseconds;
+	}
+	statistics->totalSpinNanoseconds += nanoTicks - spinStartNanoTicks;
+	
+	// Keep to the deadline cadence so small oversleeps don't accumulate into drift
+	framePacer->lastFrameNanoTicks = (errorNanoseconds < frameIntervalNanoseconds) ? deadlineNanoTicks : nanoTicks;
+}
+
+void reportFramePacerStatistics(const FramePacer *framePacer)
+{
+	const FramePacerStatistics *statistics = &framePacer->statistics;
+	if (statistics->pacedFrameCount == 0)
+	{
+		fprintf(stderr, "Frame pacing: no frames were paced\n");
+		return;
+	}
+	
+	fprintf(stderr, "Frame pacing: %llu paced frames, mean error %.3f ms, max error %.3f ms, mean spin %.3f ms\n", (unsigned long long)statistics->pacedFrameCount, statistics->totalErrorNanoseconds / (double)statistics->pacedFrameCount / 1000000.0, statistics->maxErrorNanoseconds / 1000000.0, statistics->totalSpinNanoseconds / (double)statistics->pacedFrameCount / 1000000.0);
+}
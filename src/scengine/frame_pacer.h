@@ -0,0 +1,61 @@
+/*
+ MIT License
+
+ Copyright (c) 2024 Mayur Pawashe
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#pragma once
+
+#include "thread.h"
+
+#include <stdint.h>
+
+typedef struct
+{
+	// Frames that had to wait for their deadline
+	uint64_t pacedFrameCount;
+	// How late paced frames woke up compared to their deadline
+	uint64_t totalErrorNanoseconds;
+	uint64_t maxErrorNanoseconds;
+	// Time spent spinning after sleeping
+	uint64_t totalSpinNanoseconds;
+} FramePacerStatistics;
+
+typedef struct
+{
+	uint64_t lastFrameNanoTicks;
+	ZGDelayTimer delayTimer;
+	FramePacerStatistics statistics;
+} FramePacer;
+
+// Creates the timer the pacer sleeps on and resets it
+void initFramePacer(FramePacer *framePacer);
+void destroyFramePacer(FramePacer *framePacer);
+
+// The next paced frame won't wait; used when the loop was stalled or its cadence changes
+void resetFramePacer(FramePacer *framePacer);
+
+// Waits until frameIntervalNanoseconds have passed since the previous paced frame
+// Sleeps for most of the wait and spins for the rest since even high resolution sleeps can wake up a little late
+void paceFrame(FramePacer *framePacer, uint64_t frameIntervalNanoseconds);
+
+// Prints how closely frames hit their deadlines to stderr
+void reportFramePacerStatistics(const FramePacer *framePacer);
@@ -0,0 +1,491 @@
+/*
+ MIT License
+
+ Copyright (c) 2024 Mayur Pawashe
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#include "job_system.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#if defined(_MSC_VER)
+#define JOB_THREAD_LOCAL __declspec(thread)
+#else
+#define JOB_THREAD_LOCAL _Thread_local
+#endif
+
+// Must be a power of two so indices can wrap around
+#define JOB_QUEUE_CAPACITY 1024
+#define MAX_JOB_WORKER_COUNT 64
+
+typedef struct
+{
+	JobFunction function;
+	ParallelForFunction rangeFunction;
+	void *data;
+	uint32_t startIndex;
+	uint32_t endIndex;
+	JobCounter *counter;
+	JobCounter *dependency;
+} Job;
+
+typedef struct
+{
+	ZGMutex mutex;
+	// The owner pushes and pops at the bottom while thieves take from the top
+	uint32_t top;
+	uint32_t bottom;
+	Job jobs[JOB_QUEUE_CAPACITY];
+} JobQueue;
+
+// One queue per worker, plus a last queue shared by threads outside of the pool
+static JobQueue *gJobQueues;
+static uint32_t gJobWorkerCount;
+static ZGThread gJobWorkerThreads[MAX_JOB_WORKER_COUNT];
+
+// Jobs sitting in queues that nobody has taken yet
+static ZGAtomicInt gQueuedJobCount;
+
+// Guards gStopsJobWorkers and the waiting jobs, and is what sleeping threads wait with
+static ZGMutex gJobSystemMutex;
+static ZGCondition gJobQueuedCondition;
+static ZGCondition gJobCounterFinishedCondition;
+static bool gStopsJobWorkers;
+
+// Jobs whose dependency hasn't finished yet
+static Job *gWaitingJobs;
+static uint32_t gWaitingJobCount;
+static uint32_t gWaitingJobCapacity;
+
+// The queue owned by the current thread, or NULL if it isn't a worker
+static JOB_THREAD_LOCAL JobQueue *tCurrentJobQueue;
+
+static bool pushJobQueue(JobQueue *queue, Job job)
+{
+	bool pushed = false;
+	
+	ZGLockMutex(queue->mutex);
+	if (queue->bottom - queue->top < JOB_QUEUE_CAPACITY)
+	{
+		queue->jobs[queue->bottom & (JOB_QUEUE_CAPACITY - 1)] = job;
+		queue->bottom++;
+		pushed = true;
+	}
+	ZGUnlockMutex(queue->mutex);
+	
+	return pushed;
+}
+
+static bool popJobQueue(JobQueue *queue, Job *job)
+{
+	bool popped = false;
+	
+	ZGLockMutex(queue->mutex);
+	if (queue->bottom != queue->top)
+	{
+		queue->bottom--;
+		*job = queue->jobs[queue->bottom & (JOB_QUEUE_CAPACITY - 1)];
+		popped = true;
+	}
+	ZGUnlockMutex(queue->mutex);
+	
+	return popped;
+}
+
+static bool stealJobQueue(JobQueue *queue, Job *job)
+{
+	bool stolen = false;
+	
+	ZGLockMutex(queue->mutex);
+	if (queue->bottom != queue->top)
+	{
+		*job = queue->jobs[queue->top & (JOB_QUEUE_CAPACITY - 1)];
+		queue->top++;
+		stolen = true;
+	}
+	ZGUnlockMutex(queue->mutex);
+	
+	return stolen;
+}
+
+static void pushJob(Job job);
+
+// Queues waiting jobs whose dependency has finished
+static void releaseWaitingJobs(void)
+{
+	while (true)
+	{
+		bool released = false;
+		Job job;
+		
+		ZGLockMutex(gJobSystemMutex);
+		for (uint32_t waitingJobIndex = 0; waitingJobIndex < gWaitingJobCount; waitingJobIndex++)
+		{
+			if (ZGAtomicLoad(&gWaitingJobs[waitingJobIndex].dependency->remaining) <= 0)
+			{
+				job = gWaitingJobs[waitingJobIndex];
+				gWaitingJobs[waitingJobIndex] = gWaitingJobs[gWaitingJobCount - 1];
+				gWaitingJobCount--;
+				released = true;
+				break;
+			}
+		}
+		ZGUnlockMutex(gJobSystemMutex);
+		
+		if (!released)
+		{
+			break;
+		}
+		
+		job.dependency = NULL;
+		pushJob(job);
+	}
+}
+
+static void runJob(Job job)
+{
+	if (job.function != NULL)
+	{
+		job.function(job.data);
+	}
+	else
+	{
+		job.rangeFunction(job.data, job.startIndex, job.endIndex);
+	}
+	
+	if (job.counter != NULL && ZGAtomicFetchAdd(&job.counter->remaining, -1) == 1)
+	{
+		if (gJobWorkerCount > 0)
+		{
+			// Lock so a thread about to wait on the counter can't miss the wakeup
+			ZGLockMutex(gJobSystemMutex);
+			ZGBroadcastCondition(gJobCounterFinishedCondition);
+			ZGUnlockMutex(gJobSystemMutex);
+			
+			releaseWaitingJobs();
+		}
+	}
+}
+
+static void pushJob(Job job)
+{
+	if (gJobWorkerCount == 0)
+	{
+		runJob(job);
+		return;
+	}
+	
+	JobQueue *queue = (tCurrentJobQueue != NULL) ? tCurrentJobQueue : &gJobQueues[gJobWorkerCount];
+	if (!pushJobQueue(queue, job))
+	{
+		// Rather than block on a full queue, do the work here
+		runJob(job);
+		return;
+	}
+	
+	ZGAtomicFetchAdd(&gQueuedJobCount, 1);
+	
+	ZGLockMutex(gJobSystemMutex);
+	ZGSignalCondition(gJobQueuedCondition);
+	ZGUnlockMutex(gJobSystemMutex);
+}
+
+// Runs the newest job of our own queue, or else the oldest job of another queue
+static bool runNextJob(void)
+{
+	JobQueue *ownQueue = tCurrentJobQueue;
+	uint32_t queueCount = gJobWorkerCount + 1;
+	
+	Job job;
+	bool foundJob = (ownQueue != NULL) && popJobQueue(ownQueue, &job);
+	if (!foundJob)
+	{
+		uint32_t firstQueueIndex = (ownQueue != NULL) ? (uint32_t)(ownQueue - gJobQueues) + 1 : 0;
+		for (uint32_t queueOffset = 0; queueOffset < queueCount && !foundJob; queueOffset++)
+		{
+			JobQueue *queue = &gJobQueues[(firstQueueIndex + queueOffset) % queueCount];
+			if (queue != ownQueue)
+			{
+				foundJob = stealJobQueue(queue, &job);
+			}
+		}
+	}
+	
+	if (foundJob)
+	{
+		ZGAtomicFetchAdd(&gQueuedJobCount, -1);
+		runJob(job);
+	}
+	
+	return foundJob;
+}
+
+static int jobWorkerThread(void *context)
+{
+	tCurrentJobQueue = context;
+	
+	while (true)
+	{
+		if (runNextJob())
+		{
+			continue;
+		}
+		
+		ZGLockMutex(gJobSystemMutex);
+		while (!gStopsJobWorkers && ZGAtomicLoad(&gQueuedJobCount) <= 0)
+		{
+			ZGWaitCondition(gJobQueuedCondition, gJobSystemMutex);
+		}
+		// Keep going until the queues are drained
+		bool stops = gStopsJobWorkers && ZGAtomicLoad(&gQueuedJobCount) <= 0;
+		ZGUnlockMutex(gJobSystemMutex);
+		
+		if (stops)
+		{
+			break;
+		}
+	}
+	
+	return 0;
+}
+
+void initJobSystem(uint32_t workerCount)
+{
+	if (gJobWorkerCount > 0)
+	{
+		return;
+	}
+	
+	if (workerCount == 0)
+	{
+		// Leave a processor for the submitting thread, but always have a worker so work stays off of it
+		uint32_t processorCount = ZGProcessorCount();
+		workerCount = (processorCount > 1) ? processorCount - 1 : 1;
+	}
+	if (workerCount > MAX_JOB_WORKER_COUNT)
+	{
+		workerCount = MAX_JOB_WORKER_COUNT;
+	}
+	
+	gJobQueues = calloc(workerCount + 1, sizeof(*gJobQueues));
+	if (gJobQueues == NULL)
+	{
+		fprintf(stderr, "Failed to allocate job queues\n");
+		return;
+	}
+	
+	for (uint32_t queueIndex = 0; queueIndex < workerCount + 1; queueIndex++)
+	{
+		gJobQueues[queueIndex].mutex = ZGCreateMutex();
+	}
+	
+	gJobSystemMutex = ZGCreateMutex();
+	gJobQueuedCondition = ZGCreateCondition();
+	gJobCounterFinishedCondition = ZGCreateCondition();
+	gStopsJobWorkers = false;
+	
+	// Queues must be in place before workers start looking at them
+	gJobWorkerCount = workerCount;
+	
+	uint32_t startedWorkerCount = 0;
+	for (uint32_t workerIndex = 0; workerIndex < workerCount; workerIndex++)
+	{
+		gJobWorkerThreads[workerIndex] = ZGCreateThread(jobWorkerThread, "job-worker", &gJobQueues[workerIndex]);
+		if (gJobWorkerThreads[workerIndex] != NULL)
+		{
+			startedWorkerCount++;
+		}
+	}
+	
+	// Workers that failed to start just leave their queue unused, so only give up if nobody can run jobs
+	if (startedWorkerCount == 0)
+	{
+		fprintf(stderr, "Failed to create any job workers; jobs will run on the submitting thread\n");
+		shutdownJobSystem();
+	}
+}
+
+void shutdownJobSystem(void)
+{
+	if (gJobQueues == NULL)
+	{
+		return;
+	}
+	
+	ZGLockMutex(gJobSystemMutex);
+	gStopsJobWorkers = true;
+	ZGBroadcastCondition(gJobQueuedCondition);
+	ZGUnlockMutex(gJobSystemMutex);
+	
+	for (uint32_t workerIndex = 0; workerIndex < gJobWorkerCount; workerIndex++)
+	{
+		if (gJobWorkerThreads[workerIndex] != NULL)
+		{
+			ZGWaitThread(gJobWorkerThreads[workerIndex]);
+			gJobWorkerThreads[workerIndex] = NULL;
+		}
+	}
+	
+	// Finish anything queued from outside the pool after the workers stopped looking
+	while (runNextJob())
+	{
+	}
+	
+	if (gWaitingJobCount > 0)
+	{
+		fprintf(stderr, "Dropping %u jobs whose dependencies never finished\n", gWaitingJobCount);
+	}
+	free(gWaitingJobs);
+	gWaitingJobs = NULL;
+	gWaitingJobCount = 0;
+	gWaitingJobCapacity = 0;
+	
+	for (uint32_t queueIndex = 0; queueIndex < gJobWorkerCount + 1; queueIndex++)
+	{
+		ZGDestroyMutex(gJobQueues[queueIndex].mutex);
+	}
+	free(gJobQueues);
+	gJobQueues = NULL;
+	gJobWorkerCount = 0;
+	
+	ZGDestroyCondition(gJobQueuedCondition);
+	ZGDestroyCondition(gJobCounterFinishedCondition);
+	ZGDestroyMutex(gJobSystemMutex);
+}
+
+void submitJob(JobFunction function, void *data, JobCounter *counter)
+{
+	submitJobAfter(NULL, function, data, counter);
+}
+
+void submitJobAfter(JobCounter *dependency, JobFunction function, void *data, JobCounter *counter)
+{
+	Job job = {0};
+	job.function = function;
+	job.data = data;
+	job.counter = counter;
+	
+	// Count the job before it can possibly finish
+	if (counter != NULL)
+	{
+		ZGAtomicFetchAdd(&counter->remaining, 1);
+	}
+	
+	if (dependency != NULL && gJobWorkerCount > 0)
+	{
+		bool waits = false;
+		
+		// The dependency's last job releases waiting jobs after taking this lock, so checking under it can't miss a release
+		ZGLockMutex(gJobSystemMutex);
+		if (ZGAtomicLoad(&dependency->remaining) > 0)
+		{
+			if (gWaitingJobCount == gWaitingJobCapacity)
+			{
+				uint32_t newCapacity = (gWaitingJobCapacity > 0) ? gWaitingJobCapacity * 2 : 16;
+				Job *newWaitingJobs = realloc(gWaitingJobs, newCapacity * sizeof(*newWaitingJobs));
+				if (newWaitingJobs != NULL)
+				{
+					gWaitingJobs = newWaitingJobs;
+					gWaitingJobCapacity = newCapacity;
+				}
+			}
+			
+			if (gWaitingJobCount < gWaitingJobCapacity)
+			{
+				job.dependency = dependency;
+				gWaitingJobs[gWaitingJobCount] = job;
+				gWaitingJobCount++;
+				waits = true;
+			}
+		}
+		ZGUnlockMutex(gJobSystemMutex);
+		
+		if (waits)
+		{
+			return;
+		}
+		
+		// Couldn't make room to hold the job so wait out the dependency here instead
+		waitForJobs(dependency);
+	}
+	
+	pushJob(job);
+}
+
+void waitForJobs(JobCounter *counter)
+{
+	while (ZGAtomicLoad(&counter->remaining) > 0)
+	{
+		if (gJobWorkerCount == 0)
+		{
+			// Everything ran as soon as it was submitted; whatever is left is up to the caller
+			fprintf(stderr, "Waiting on jobs that will never run\n");
+			break;
+		}
+		
+		// Help out rather than sit idle
+		if (runNextJob())
+		{
+			continue;
+		}
+		
+		ZGLockMutex(gJobSystemMutex);
+		while (ZGAtomicLoad(&counter->remaining) > 0 && ZGAtomicLoad(&gQueuedJobCount) <= 0)
+		{
+			ZGWaitCondition(gJobCounterFinishedCondition, gJobSystemMutex);
+		}
+		ZGUnlockMutex(gJobSystemMutex);
+	}
+}
+
+void parallelFor(uint32_t count, uint32_t batchSize, ParallelForFunction function, void *data)
+{
+	if (batchSize == 0)
+	{
+		batchSize = 1;
+	}
+	
+	JobCounter counter = {0};
+	
+	// The calling thread takes the first batch itself after handing out the rest
+	uint32_t firstBatchEndIndex = (count < batchSize) ? count : batchSize;
+	for (uint32_t startIndex = firstBatchEndIndex; startIndex < count; startIndex += batchSize)
+	{
+		Job job = {0};
+		job.rangeFunction = function;
+		job.data = data;
+		job.startIndex = startIndex;
+		job.endIndex = (count - startIndex < batchSize) ? count : startIndex + batchSize;
+		job.counter = &counter;
+		
+		ZGAtomicFetchAdd(&counter.remaining, 1);
+		pushJob(job);
+	}
+	
+	if (firstBatchEndIndex > 0)
+	{
+		function(data, 0, firstBatchEndIndex);
+	}
+	
+	waitForJobs(&counter);
+}
@@ -0,0 +1,61 @@
+/*
+ MIT License
+
+ Copyright (c) 2024 Mayur Pawashe
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#pragma once
+
+#include "thread.h"
+
+#include <stdint.h>
+
+// A fixed pool of worker threads shared by everything that needs work done in the background
+// Each worker owns a deque: it runs its own newest jobs first and steals the oldest jobs of others when it runs dry
+
+typedef void (*JobFunction)(void *data);
+// Called with a batch [startIndex, endIndex) of the range passed to parallelFor()
+typedef void (*ParallelForFunction)(void *data, uint32_t startIndex, uint32_t endIndex);
+
+// Counts the jobs submitted with it that haven't finished yet; zero-initialize before first use
+typedef struct
+{
+	ZGAtomicInt remaining;
+} JobCounter;
+
+// Passing 0 workers uses one worker per processor besides the calling thread
+// Until this is called (or if no workers can be created) jobs run immediately on the submitting thread
+void initJobSystem(uint32_t workerCount);
+
+// Finishes all queued jobs and joins the workers
+void shutdownJobSystem(void);
+
+// counter may be NULL if nobody waits on the job
+void submitJob(JobFunction function, void *data, JobCounter *counter);
+
+// Queues the job only once every job counted by dependency has finished
+void submitJobAfter(JobCounter *dependency, JobFunction function, void *data, JobCounter *counter);
+
+// Runs other jobs on the calling thread until every job counted by counter has finished
+void waitForJobs(JobCounter *counter);
+
+// Splits [0, count) into batches of batchSize and returns once all of them have run
+void parallelFor(uint32_t count, uint32_t batchSize, ParallelForFunction function, void *data);
@@ -0,0 +1,132 @@
+/*
+ MIT License
+
+ Copyright (c) 2024 Mayur Pawashe
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#include "launch_profile.h"
+#include "zgtime.h"
+#include "thread.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define PROFILE_LAUNCH_ENVIRONMENT_VARIABLE "PROFILE_LAUNCH"
+#define MAX_LAUNCH_PHASE_COUNT 32
+
+typedef struct
+{
+	const char *name;
+	uint64_t nanoTicks;
+} LaunchPhase;
+
+static bool gLaunchProfileEnabled;
+static bool gLaunchProfileFinished;
+static const char *gLaunchProfileOutputPath;
+static ZGMutex gLaunchProfileMutex;
+static uint64_t gLaunchProfileStartNanoTicks;
+static LaunchPhase gLaunchPhases[MAX_LAUNCH_PHASE_COUNT];
+static uint32_t gLaunchPhaseCount;
+
+void beginLaunchProfile(void)
+{
+	const char *profileLaunchValue = getenv(PROFILE_LAUNCH_ENVIRONMENT_VARIABLE);
+	if (profileLaunchValue == NULL || profileLaunchValue[0] == '\0' || strcmp(profileLaunchValue, "0") == 0)
+	{
+		return;
+	}
+	
+	gLaunchProfileOutputPath = (strcmp(profileLaunchValue, "1") == 0) ? NULL : profileLaunchValue;
+	gLaunchProfileMutex = ZGCreateMutex();
+	gLaunchProfileStartNanoTicks = ZGGetNanoTicks();
+	gLaunchProfileEnabled = true;
+}
+
+static void recordLaunchPhase(const char *phaseName, uint64_t nanoTicks)
+{
+	if (gLaunchPhaseCount < MAX_LAUNCH_PHASE_COUNT)
+	{
+		gLaunchPhases[gLaunchPhaseCount].name = phaseName;
+		gLaunchPhases[gLaunchPhaseCount].nanoTicks = nanoTicks;
+		gLaunchPhaseCount++;
+	}
+}
+
+void markLaunchPhase(const char *phaseName)
+{
+	if (!gLaunchProfileEnabled)
+	{
+		return;
+	}
+	
+	uint64_t nanoTicks = ZGGetNanoTicks();
+	
+	ZGLockMutex(gLaunchProfileMutex);
+	if (!gLaunchProfileFinished)
+	{
+		recordLaunchPhase(phaseName, nanoTicks);
+	}
+	ZGUnlockMutex(gLaunchProfileMutex);
+}
+
+void finishLaunchProfile(const char *phaseName)
+{
+	if (!gLaunchProfileEnabled || gLaunchProfileFinished)
+	{
+		return;
+	}
+	
+	uint64_t nanoTicks = ZGGetNanoTicks();
+	
+	ZGLockMutex(gLaunchProfileMutex);
+	recordLaunchPhase(phaseName, nanoTicks);
+	gLaunchProfileFinished = true;
+	ZGUnlockMutex(gLaunchProfileMutex);
+	
+	FILE *outputFile = stderr;
+	if (gLaunchProfileOutputPath != NULL)
+	{
+		outputFile = fopen(gLaunchProfileOutputPath, "w");
+		if (outputFile == NULL)
+		{
+			fprintf(stderr, "Error: failed to open launch profile output: %s\n", gLaunchProfileOutputPath);
+			return;
+		}
+	}
+	
+	fprintf(outputFile, "Launch profile (ms)\n");
+	fprintf(outputFile, "%-40s %10s %10s\n", "phase", "duration", "elapsed");
+	
+	uint64_t previousNanoTicks = gLaunchProfileStartNanoTicks;
+	for (uint32_t phaseIndex = 0; phaseIndex < gLaunchPhaseCount; phaseIndex++)
+	{
+		const LaunchPhase *phase = &gLaunchPhases[phaseIndex];
+		fprintf(outputFile, "%-40s %10.3f %10.3f\n", phase->name, (phase->nanoTicks - previousNanoTicks) / 1000000.0, (phase->nanoTicks - gLaunchProfileStartNanoTicks) / 1000000.0);
+		previousNanoTicks = phase->nanoTicks;
+	}
+	
+	if (outputFile != stderr)
+	{
+		fclose(outputFile);
+	}
+}
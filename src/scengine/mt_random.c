@@ -1,20 +1,6 @@
 
 #include "mt_random.h"
-#include <stdlib.h>
-#include <time.h>
-
-#define MT_LEN			624
-
-int mt_index;
-unsigned long mt_buffer[MT_LEN];
-
-void mt_init(void) {
-    srand((unsigned int)time(NULL));
-	int i;
-    for (i = 0; i < MT_LEN; i++)
-        mt_buffer[i] = rand();
-    mt_index = 0;
-}
+#include <string.h>
 
 #define MT_IA           397
 #define MT_IB           (MT_LEN - MT_IA)
@@ -24,38 +10,59 @@ void mt_init(void) {
 #define TWIST(b,i,j)    ((b)[i] & UPPER_MASK) | ((b)[j] & LOWER_MASK)
 #define MAGIC(s)        (((s)&1)*MATRIX_A)
 
-unsigned long mt_random(void) {
-    unsigned long * b = mt_buffer;
-    int idx = mt_index;
-    unsigned long s;
-    int i;
-	
-    if (idx == MT_LEN*sizeof(unsigned long))
-    {
-        idx = 0;
-        i = 0;
-        for (; i < MT_IB; i++) {
-            s = TWIST(b, i, i+1);
-            b[i] = b[i + MT_IA] ^ (s >> 1) ^ MAGIC(s);
-        }
-        for (; i < MT_LEN-1; i++) {
-            s = TWIST(b, i, i+1);
-            b[i] = b[i - MT_IB] ^ (s >> 1) ^ MAGIC(s);
-        }
+void mt_seed(MTState *state, uint32_t seed) {
+    uint32_t *b = state->buffer;
+    b[0] = seed;
+    for (uint32_t i = 1; i < MT_LEN; i++)
+        b[i] = 1812433253U * (b[i-1] ^ (b[i-1] >> 30)) + i;
+    state->index = MT_LEN;
+}
+
+static void mt_regenerate(MTState *state) {
+    uint32_t *b = state->buffer;
+    uint32_t s;
+    int i = 0;
+    for (; i < MT_IB; i++) {
+        s = TWIST(b, i, i+1);
+        b[i] = b[i + MT_IA] ^ (s >> 1) ^ MAGIC(s);
+    }
+    for (; i < MT_LEN-1; i++) {
+        s = TWIST(b, i, i+1);
+        b[i] = b[i - MT_IB] ^ (s >> 1) ^ MAGIC(s);
+    }
+    
+    s = TWIST(b, MT_LEN-1, 0);
+    b[MT_LEN-1] = b[MT_IA-1] ^ (s >> 1) ^ MAGIC(s);
+    state->index = 0;
+}
+
+static uint32_t mt_temper(uint32_t r) {
+    r ^= (r >> 11);
+    r ^= (r << 7) & 0x9D2C5680;
+    r ^= (r << 15) & 0xEFC60000;
+    r ^= (r >> 18);
+    return r;
+}
+
+uint32_t mt_next(MTState *state) {
+    if (state->index >= MT_LEN)
+        mt_regenerate(state);
+    return mt_temper(state->buffer[state->index++]);
+}
+
+void mt_fill(MTState *state, uint32_t *out, size_t count) {
+    while (count > 0) {
+        if (state->index >= MT_LEN)
+            mt_regenerate(state);
+        
+        size_t available = MT_LEN - state->index;
+        size_t batch = (count < available) ? count : available;
+        const uint32_t *b = state->buffer + state->index;
+        for (size_t i = 0; i < batch; i++)
+            out[i] = mt_temper(b[i]);
         
-        s = TWIST(b, MT_LEN-1, 0);
-        b[MT_LEN-1] = b[MT_IA-1] ^ (s >> 1) ^ MAGIC(s);
+        state->index += (uint32_t)batch;
+        out += batch;
+        count -= batch;
     }
-    mt_index = idx + sizeof(unsigned long);
-    return *(unsigned long *)((unsigned char *)b + idx);
-    /*
-	 Matsumoto and Nishimura additionally confound the bits returned to the caller
-	 but this doesn't increase the randomness, and slows down the generator by
-	 as much as 25%.  So I omit these operations here.
-	 
-	 r ^= (r >> 11);
-	 r ^= (r << 7) & 0x9D2C5680;
-	 r ^= (r << 15) & 0xEFC60000;
-	 r ^= (r >> 18);
-	 */
 }
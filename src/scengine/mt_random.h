@@ -3,8 +3,23 @@
 /*
 * Using the Mersenne Twister Random number generator
 * http://www.qbrundage.com/michaelb/pubs/essays/random_number_generation
-* This code is licensed as "Public Domain" (mt_init(), mt_random())
+* This code is licensed as "Public Domain" (mt_seed(), mt_next(), mt_fill())
 */
 
-void mt_init(void);
-unsigned long mt_random(void);
+#include <stddef.h>
+#include <stdint.h>
+
+#define MT_LEN 624
+
+// All generator state lives here so each owner can seed and draw from its own sequence
+typedef struct
+{
+    uint32_t buffer[MT_LEN];
+    uint32_t index;
+} MTState;
+
+void mt_seed(MTState *state, uint32_t seed);
+uint32_t mt_next(MTState *state);
+
+// Fills out with the next count numbers, regenerating the state in whole blocks where possible
+void mt_fill(MTState *state, uint32_t *out, size_t count);
@@ -0,0 +1,350 @@
+/*
+ MIT License
+
+ Copyright (c) 2024 Mayur Pawashe
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#include "program_cache_gl.h"
+#include "defaults.h"
+
+#include "glad/gl.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define PROGRAM_CACHE_FILE_NAME "gl_program_cache.bin"
+#define PROGRAM_CACHE_MAGIC "DDPB"
+#define PROGRAM_CACHE_VERSION 1
+#define MAX_CACHED_PROGRAM_COUNT 8
+#define MAX_PROGRAM_CACHE_DRIVER_KEY_LENGTH 1024
+
+typedef struct
+{
+	uint64_t key;
+	uint32_t binaryFormat;
+	uint32_t binaryLength;
+	const uint8_t *binary;
+} CachedProgramBinary;
+
+struct _ProgramCache
+{
+	const char *defaultsName;
+	
+	char driverKey[MAX_PROGRAM_CACHE_DRIVER_KEY_LENGTH];
+	uint32_t driverKeyLength;
+	
+	// Binaries read from the cache file; they point into fileData
+	uint8_t *fileData;
+	CachedProgramBinary loadedBinaries[MAX_CACHED_PROGRAM_COUNT];
+	uint32_t loadedBinaryCount;
+	
+	// Programs that will be written out to the cache file
+	uint64_t programKeys[MAX_CACHED_PROGRAM_COUNT];
+	uint32_t programs[MAX_CACHED_PROGRAM_COUNT];
+	uint32_t programCount;
+	
+	bool needsSaving;
+};
+
+static bool readCacheBytes(const uint8_t **cursor, const uint8_t *end, void *bytes, size_t count)
+{
+	if ((size_t)(end - *cursor) < count)
+	{
+		return false;
+	}
+	memcpy(bytes, *cursor, count);
+	*cursor += count;
+	return true;
+}
+
+static void loadCachedBinaries(ProgramCache *cache, FILE *file)
+{
+	if (fseek(file, 0, SEEK_END) != 0)
+	{
+		return;
+	}
+	
+	long fileSize = ftell(file);
+	if (fileSize <= 0 || fseek(file, 0, SEEK_SET) != 0)
+	{
+		return;
+	}
+	
+	uint8_t *fileData = malloc((size_t)fileSize);
+	if (fileData == NULL)
+	{
+		return;
+	}
+	
+	if (fread(fileData, (size_t)fileSize, 1, file) < 1)
+	{
+		free(fileData);
+		return;
+	}
+	
+	const uint8_t *cursor = fileData;
+	const uint8_t *end = fileData + fileSize;
+	
+	char magic[4];
+	uint32_t version = 0;
+	uint32_t driverKeyLength = 0;
+	uint32_t binaryCount = 0;
+	
+	bool valid =
+		readCacheBytes(&cursor, end, magic, sizeof(magic)) && memcmp(magic, PROGRAM_CACHE_MAGIC, sizeof(magic)) == 0 &&
+		readCacheBytes(&cursor, end, &version, sizeof(version)) && version == PROGRAM_CACHE_VERSION &&
+		readCacheBytes(&cursor, end, &driverKeyLength, sizeof(driverKeyLength)) && driverKeyLength == cache->driverKeyLength &&
+		(size_t)(end - cursor) >= driverKeyLength && memcmp(cursor, cache->driverKey, driverKeyLength) == 0;
+	
+	if (valid)
+	{
+		cursor += driverKeyLength;
+		valid = readCacheBytes(&cursor, end, &binaryCount, sizeof(binaryCount)) && binaryCount <= MAX_CACHED_PROGRAM_COUNT;
+	}
+	
+	for (uint32_t binaryIndex = 0; valid && binaryIndex < binaryCount; binaryIndex++)
+	{
+		CachedProgramBinary *binary = &cache->loadedBinaries[binaryIndex];
+		valid =
+			readCacheBytes(&cursor, end, &binary->key, sizeof(binary->key)) &&
+			readCacheBytes(&cursor, end, &binary->binaryFormat, sizeof(binary->binaryFormat)) &&
+			readCacheBytes(&cursor, end, &binary->binaryLength, sizeof(binary->binaryLength)) &&
+			(size_t)(end - cursor) >= binary->binaryLength;
+		
+		if (valid)
+		{
+			binary->binary = cursor;
+			cursor += binary->binaryLength;
+		}
+	}
+	
+	if (!valid)
+	{
+		// Stale or corrupt caches are replaced once the programs are compiled again
+		free(fileData);
+		return;
+	}
+	
+	cache->fileData = fileData;
+	cache->loadedBinaryCount = binaryCount;
+}
+
+ProgramCache *loadProgramCache(const char *defaultsName)
+{
+	GLint binaryFormatCount = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormatCount);
+	if (binaryFormatCount <= 0)
+	{
+		return NULL;
+	}
+	
+	ProgramCache *cache = calloc(1, sizeof(*cache));
+	if (cache == NULL)
+	{
+		return NULL;
+	}
+	
+	cache->defaultsName = defaultsName;
+	
+	// Binaries are only valid for the driver that produced them
+	const char *vendor = (const char *)glGetString(GL_VENDOR);
+	const char *rendererName = (const char *)glGetString(GL_RENDERER);
+	const char *version = (const char *)glGetString(GL_VERSION);
+	int driverKeyLength = snprintf(cache->driverKey, sizeof(cache->driverKey), "%s\n%s\n%s", vendor != NULL ? vendor : "", rendererName != NULL ? rendererName : "", version != NULL ? version : "");
+	cache->driverKeyLength = (driverKeyLength < 0) ? 0 : (((size_t)driverKeyLength >= sizeof(cache->driverKey)) ? (uint32_t)sizeof(cache->driverKey) - 1 : (uint32_t)driverKeyLength);
+	
+	FILE *file = getUserDataFileWithName(defaultsName, PROGRAM_CACHE_FILE_NAME, "rb");
+	if (file != NULL)
+	{
+		loadCachedBinaries(cache, file);
+		fclose(file);
+	}
+	
+	return cache;
+}
+
+// FNV-1a
+static uint64_t hashProgramCacheBytes(uint64_t hash, const void *bytes, size_t count)
+{
+	const uint8_t *byteArray = bytes;
+	for (size_t byteIndex = 0; byteIndex < count; byteIndex++)
+	{
+		hash ^= byteArray[byteIndex];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+uint64_t programCacheKey(const char *vertexShaderSource, const char *fragmentShaderSource, uint16_t glslVersion, bool textured, bool instanced)
+{
+	uint64_t hash = 14695981039346656037ull;
+	hash = hashProgramCacheBytes(hash, vertexShaderSource, strlen(vertexShaderSource) + 1);
+	hash = hashProgramCacheBytes(hash, fragmentShaderSource, strlen(fragmentShaderSource) + 1);
+	hash = hashProgramCacheBytes(hash, &glslVersion, sizeof(glslVersion));
+	hash = hashProgramCacheBytes(hash, &textured, sizeof(textured));
+	hash = hashProgramCacheBytes(hash, &instanced, sizeof(instanced));
+	return hash;
+}
+
+uint32_t programFromCache(ProgramCache *cache, uint64_t programKey)
+{
+	if (cache == NULL)
+	{
+		return 0;
+	}
+	
+	for (uint32_t binaryIndex = 0; binaryIndex < cache->loadedBinaryCount; binaryIndex++)
+	{
+		const CachedProgramBinary *binary = &cache->loadedBinaries[binaryIndex];
+		if (binary->key != programKey)
+		{
+			continue;
+		}
+		
+		GLuint program = glCreateProgram();
+		if (program == 0)
+		{
+			return 0;
+		}
+		
+		glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		glProgramBinary(program, binary->binaryFormat, binary->binary, (GLsizei)binary->binaryLength);
+		
+		// Drivers may reject binaries they produced before, such as after an update that kept the same version string
+		GLint status = 0;
+		glGetProgramiv(program, GL_LINK_STATUS, &status);
+		if (status == 0)
+		{
+			glDeleteProgram(program);
+			return 0;
+		}
+		
+		return program;
+	}
+	
+	return 0;
+}
+
+void addProgramToCache(ProgramCache *cache, uint64_t programKey, uint32_t program)
+{
+	if (cache == NULL || cache->programCount >= MAX_CACHED_PROGRAM_COUNT)
+	{
+		return;
+	}
+	
+	cache->programKeys[cache->programCount] = programKey;
+	cache->programs[cache->programCount] = program;
+	cache->programCount++;
+	
+	bool loadedFromCache = false;
+	for (uint32_t binaryIndex = 0; binaryIndex < cache->loadedBinaryCount; binaryIndex++)
+	{
+		if (cache->loadedBinaries[binaryIndex].key == programKey)
+		{
+			loadedFromCache = true;
+			break;
+		}
+	}
+	
+	if (!loadedFromCache)
+	{
+		cache->needsSaving = true;
+	}
+}
+
+static void writeProgramCache(ProgramCache *cache)
+{
+	FILE *file = getUserDataFileWithName(cache->defaultsName, PROGRAM_CACHE_FILE_NAME, "wb");
+	if (file == NULL)
+	{
+		fprintf(stderr, "Error: failed to open GL program cache for writing\n");
+		return;
+	}
+	
+	uint32_t version = PROGRAM_CACHE_VERSION;
+	uint32_t programCount = cache->programCount;
+	
+	bool succeeded =
+		fwrite(PROGRAM_CACHE_MAGIC, 4, 1, file) == 1 &&
+		fwrite(&version, sizeof(version), 1, file) == 1 &&
+		fwrite(&cache->driverKeyLength, sizeof(cache->driverKeyLength), 1, file) == 1 &&
+		fwrite(cache->driverKey, cache->driverKeyLength, 1, file) == 1 &&
+		fwrite(&programCount, sizeof(programCount), 1, file) == 1;
+	
+	for (uint32_t programIndex = 0; succeeded && programIndex < cache->programCount; programIndex++)
+	{
+		GLuint program = cache->programs[programIndex];
+		
+		GLint binaryLength = 0;
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+		
+		void *binary = (binaryLength > 0) ? malloc((size_t)binaryLength) : NULL;
+		if (binary == NULL)
+		{
+			succeeded = false;
+			break;
+		}
+		
+		GLenum binaryFormat = 0;
+		GLsizei writtenLength = 0;
+		glGetProgramBinary(program, binaryLength, &writtenLength, &binaryFormat, binary);
+		
+		uint32_t storedFormat = (uint32_t)binaryFormat;
+		uint32_t storedLength = (uint32_t)writtenLength;
+		
+		succeeded =
+			writtenLength > 0 &&
+			fwrite(&cache->programKeys[programIndex], sizeof(cache->programKeys[programIndex]), 1, file) == 1 &&
+			fwrite(&storedFormat, sizeof(storedFormat), 1, file) == 1 &&
+			fwrite(&storedLength, sizeof(storedLength), 1, file) == 1 &&
+			fwrite(binary, storedLength, 1, file) == 1;
+		
+		free(binary);
+	}
+	
+	fclose(file);
+	
+	if (!succeeded)
+	{
+		// Leave an empty file behind rather than a truncated one
+		file = getUserDataFileWithName(cache->defaultsName, PROGRAM_CACHE_FILE_NAME, "wb");
+		if (file != NULL)
+		{
+			fclose(file);
+		}
+		fprintf(stderr, "Error: failed to write GL program cache\n");
+	}
+}
+
+void saveProgramCache(ProgramCache *cache)
+{
+	if (cache == NULL)
+	{
+		return;
+	}
+	
+	if (cache->needsSaving)
+	{
+		writeProgramCache(cache);
+	}
+	
+	free(cache->fileData);
+	free(cache);
+}
@@ -0,0 +1,48 @@
+/*
+ MIT License
+
+ Copyright (c) 2024 Mayur Pawashe
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Caches linked GL program binaries in the user data directory so later launches can skip compiling shaders
+// Cached binaries are only used with the same GL vendor, renderer and version strings they were created with
+typedef struct _ProgramCache ProgramCache;
+
+// Requires a current GL context
+// Returns NULL if the driver can't save program binaries or if the cache can't be allocated
+ProgramCache *loadProgramCache(const char *defaultsName);
+
+// Identifies a program by its shader sources and attribute bindings
+uint64_t programCacheKey(const char *vertexShaderSource, const char *fragmentShaderSource, uint16_t glslVersion, bool textured, bool instanced);
+
+// Returns a linked program restored from the cache, or 0 if the program has to be compiled
+uint32_t programFromCache(ProgramCache *cache, uint64_t programKey);
+
+// Programs must be linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set before they are added
+void addProgramToCache(ProgramCache *cache, uint64_t programKey, uint32_t program);
+
+// Writes out the cache if any program wasn't restored from it, and frees the cache
+void saveProgramCache(ProgramCache *cache);
@@ -25,6 +25,7 @@
 #include "renderer.h"
 #include "platforms.h"
 #include "window.h"
+#include "launch_profile.h"
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
@@ -73,6 +74,7 @@ void updateViewport(Renderer *renderer, int32_t windowWidth, int32_t windowHeigh
 void renderFrame(Renderer *renderer, void (*drawFunc)(Renderer *, void *), void *context)
 {
 	renderer->renderFramePtr(renderer, drawFunc, context);
+	finishLaunchProfile("first frame presented");
 }
 
 TextureObject textureFromPixelData(Renderer *renderer, const void *pixels, int32_t width, int32_t height, PixelFormat pixelFormat)
@@ -136,6 +138,30 @@ void drawVerticesFromIndices(Renderer *renderer, mat4_t modelViewMatrix, Rendere
 	renderer->drawVerticesFromIndicesPtr(renderer, &modelViewProjectionMatrix.m00, mode, vertexArrayObject, indicesBufferObject, indicesCount, color, options);
 }
 
+void drawVerticesFromIndicesInstanced(Renderer *renderer, mat4_t modelViewMatrix, RendererMode mode, BufferArrayObject vertexArrayObject, BufferObject indicesBufferObject, uint32_t indicesCount, const RendererInstance *instances, uint32_t instanceCount, RendererOptions options)
+{
+	if (instanceCount == 0)
+	{
+		return;
+	}
+	
+	if (renderer->drawVerticesFromIndicesInstancedPtr != NULL)
+	{
+		mat4_t modelViewProjectionMatrix = computeModelViewProjectionMatrix(renderer->projectionMatrix, modelViewMatrix);
+		renderer->drawVerticesFromIndicesInstancedPtr(renderer, &modelViewProjectionMatrix.m00, mode, vertexArrayObject, indicesBufferObject, indicesCount, instances, instanceCount, options);
+	}
+	else
+	{
+		for (uint32_t instanceIndex = 0; instanceIndex < instanceCount; instanceIndex++)
+		{
+			const RendererInstance *instance = &instances[instanceIndex];
+			mat4_t instanceModelViewMatrix = m4_mul(modelViewMatrix, m4_translation((vec3_t){instance->translation[0], instance->translation[1], instance->translation[2]}));
+			
+			drawVerticesFromIndices(renderer, instanceModelViewMatrix, mode, vertexArrayObject, indicesBufferObject, indicesCount, instance->color, options);
+		}
+	}
+}
+
 void drawTextureWithVertices(Renderer *renderer, mat4_t modelViewMatrix, TextureObject texture, RendererMode mode, BufferArrayObject vertexAndTextureArrayObject, uint32_t vertexCount, color4_t color, RendererOptions options)
 {
 	mat4_t modelViewProjectionMatrix = computeModelViewProjectionMatrix(renderer->projectionMatrix, modelViewMatrix);
@@ -148,6 +174,30 @@ void drawTextureWithVerticesFromIndices(Renderer *renderer, mat4_t modelViewMatr
 	renderer->drawTextureWithVerticesFromIndicesPtr(renderer, &modelViewProjectionMatrix.m00, texture, mode, vertexAndTextureArrayObject, indicesBufferObject, indicesCount, color, options);
 }
 
+bool canDrawTextureQuads(Renderer *renderer)
+{
+	return (renderer->drawTextureQuadsPtr != NULL);
+}
+
+void drawTextureQuads(Renderer *renderer, mat4_t modelViewMatrix, TextureObject texture, const RendererTextureVertex *vertices, uint32_t quadCount, color4_t color, RendererOptions options)
+{
+	if (quadCount == 0)
+	{
+		return;
+	}
+	
+	mat4_t modelViewProjectionMatrix = computeModelViewProjectionMatrix(renderer->projectionMatrix, modelViewMatrix);
+	renderer->drawTextureQuadsPtr(renderer, &modelViewProjectionMatrix.m00, texture, vertices, quadCount, color, options);
+}
+
+void reportRendererStatistics(Renderer *renderer)
+{
+	if (renderer->reportStatisticsPtr != NULL)
+	{
+		renderer->reportStatisticsPtr(renderer);
+	}
+}
+
 void pushDebugGroup(Renderer *renderer, const char *debugGroupName)
 {
 	renderer->pushDebugGroupPtr(renderer, debugGroupName);
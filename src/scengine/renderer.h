@@ -26,6 +26,10 @@
 
 #include "math_3d.h"
 #include "renderer_types.h"
+#include "platforms.h"
+
+// Only the OpenGL renderer implements drawTextureQuads(), so atlas work can be skipped before a renderer exists
+#define RENDERER_CAN_DRAW_TEXTURE_QUADS PLATFORM_LINUX
 
 void createRenderer(Renderer *renderer, RendererCreateOptions options);
 
@@ -49,9 +53,24 @@ void drawVertices(Renderer *renderer, mat4_t modelViewMatrix, RendererMode mode,
 
 void drawVerticesFromIndices(Renderer *renderer, mat4_t modelViewMatrix, RendererMode mode, BufferArrayObject vertexArrayObject, BufferObject indicesBufferObject, uint32_t indicesCount, color4_t color, RendererOptions options);
 
+// Draws instanceCount copies of the indexed vertices in as few draw calls as the renderer allows
+// Each instance is translated by its own translation (before modelViewMatrix is applied) and drawn with its own color
+void drawVerticesFromIndicesInstanced(Renderer *renderer, mat4_t modelViewMatrix, RendererMode mode, BufferArrayObject vertexArrayObject, BufferObject indicesBufferObject, uint32_t indicesCount, const RendererInstance *instances, uint32_t instanceCount, RendererOptions options);
+
 void drawTextureWithVertices(Renderer *renderer, mat4_t modelViewMatrix, TextureObject texture, RendererMode mode, BufferArrayObject vertexAndTextureArrayObject, uint32_t vertexCount, color4_t color, RendererOptions options);
 
 void drawTextureWithVerticesFromIndices(Renderer *renderer, mat4_t modelViewMatrix, TextureObject texture, RendererMode mode, BufferArrayObject vertexAndTextureArrayObject, BufferObject indicesBufferObject, uint32_t indicesCount, color4_t color, RendererOptions options);
 
+// Returns true if the renderer can draw quads with drawTextureQuads
+// Never true unless RENDERER_CAN_DRAW_TEXTURE_QUADS is set
+bool canDrawTextureQuads(Renderer *renderer);
+
+// Draws quadCount textured quads (4 vertices each) streamed from vertices in a single batch
+// Must only be called if canDrawTextureQuads() returns true
+void drawTextureQuads(Renderer *renderer, mat4_t modelViewMatrix, TextureObject texture, const RendererTextureVertex *vertices, uint32_t quadCount, color4_t color, RendererOptions options);
+
+// Prints counters the renderer keeps about its own work to stderr, if it keeps any
+void reportRendererStatistics(Renderer *renderer);
+
 void pushDebugGroup(Renderer *renderer, const char *debugGroupName);
 void popDebugGroup(Renderer *renderer);
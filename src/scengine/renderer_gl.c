@@ -25,23 +25,62 @@
 #include "renderer_gl.h"
 
 #include "renderer_projection.h"
+#include "program_cache_gl.h"
+#include "shaders_gl.h"
 #include "texture.h"
 #include "quit.h"
 #include "window.h"
+#include "launch_profile.h"
 
 #include "glad/gl.h"
 #include <SDL3/SDL.h>
 #include <SDL3/SDL_opengl.h>
 #include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
 #include <math.h>
 
 #define VERTEX_ATTRIBUTE 0
 #define TEXTURE_ATTRIBUTE 1
+#define INSTANCE_TRANSLATION_ATTRIBUTE 2
+#define INSTANCE_COLOR_ATTRIBUTE 3
 
 #define GLSL_VERSION_410 410
 
+// Texture quads are streamed in batches of up to this many quads per draw call
+#define MAX_TEXTURE_QUAD_BATCH_COUNT 256
+
+// Value for state cache entries that must be re-issued before they can be trusted
+#define GL_STATE_CACHE_UNKNOWN UINT32_MAX
+
+// Passed to glMaxShaderCompilerThreadsKHR() to let the driver pick how many threads to use
+#define MAX_SHADER_COMPILER_THREADS_UNLIMITED 0xFFFFFFFF
+
+typedef void (*MaxShaderCompilerThreadsFunction_gl)(GLuint count);
+
+// A shader whose program is compiled and linked in the background until its status is needed
+typedef struct
+{
+	Shader_gl *shader;
+	const char *shaderName;
+	const char *vertexShaderSource;
+	const char *fragmentShaderSource;
+	const char *modelViewProjectionUniform;
+	const char *colorUniform;
+	const char *textureSampleUniform;
+	bool textured;
+	bool instanced;
+	bool cached;
+	uint64_t programKey;
+	GLuint program;
+	GLuint vertexShader;
+	GLuint fragmentShader;
+} ShaderCompilation_gl;
+
 static void updateViewport_gl(Renderer *renderer, int32_t windowWidth, int32_t windowHeight);
 
+static void resetStateCache(Renderer *renderer);
+
 void renderFrame_gl(Renderer *renderer, void (*drawFunc)(Renderer *, void *), void *);
 
 TextureObject textureFromPixelData_gl(Renderer *renderer, const void *pixels, int32_t width, int32_t height, PixelFormat pixelFormat);
@@ -58,75 +97,63 @@ void drawVertices_gl(Renderer *renderer, float *modelViewProjectionMatrix, Rende
 
 void drawVerticesFromIndices_gl(Renderer *renderer, float *modelViewProjectionMatrix, RendererMode mode, BufferArrayObject vertexArrayObject, BufferObject indicesBufferObject, uint32_t indicesCount, color4_t color, RendererOptions options);
 
+void drawVerticesFromIndicesInstanced_gl(Renderer *renderer, float *modelViewProjectionMatrix, RendererMode mode, BufferArrayObject vertexArrayObject, BufferObject indicesBufferObject, uint32_t indicesCount, const RendererInstance *instances, uint32_t instanceCount, RendererOptions options);
+
 void drawTextureWithVertices_gl(Renderer *renderer, float *modelViewProjectionMatrix, TextureObject texture, RendererMode mode, BufferArrayObject vertexAndTextureArrayObject, uint32_t vertexCount, color4_t color, RendererOptions options);
 
 void drawTextureWithVerticesFromIndices_gl(Renderer *renderer, float *modelViewProjectionMatrix, TextureObject texture, RendererMode mode, BufferArrayObject vertexAndTextureArrayObject, BufferObject indicesBufferObject, uint32_t indicesCount, color4_t color, RendererOptions options);
 
+void drawTextureQuads_gl(Renderer *renderer, float *modelViewProjectionMatrix, TextureObject texture, const RendererTextureVertex *vertices, uint32_t quadCount, color4_t color, RendererOptions options);
+
 void pushDebugGroup_gl(Renderer *renderer, const char *groupName);
 
 void popDebugGroup_gl(Renderer *renderer);
 
-static bool compileShader(GLuint *shader, uint16_t glslVersion, GLenum type, const char *filepath)
+// Prints how many GL state changes the state cache issued and skipped per frame to stderr
+static void reportStatistics_gl(Renderer *renderer);
+
+// Compiles and links are only issued here and their status is checked later so that drivers may work on them in parallel
+static GLuint beginCompilingShader(uint16_t glslVersion, GLenum type, const char *source)
 {
-	GLint status;
-	
-	FILE *sourceFile = fopen(filepath, "r");
-	if (sourceFile == NULL)
-	{
-		fprintf(stderr, "Shader doesn't exist at: %s\n", filepath);
-		return false;
-	}
-	
-	fseek(sourceFile, 0, SEEK_END);
-	GLint fileSize = (GLint)ftell(sourceFile);
-	fseek(sourceFile, 0, SEEK_SET);
-	
-	GLchar *source = (GLchar *)malloc(fileSize);
-	if (fread(source, fileSize, 1, sourceFile) < 1)
-	{
-		fprintf(stderr, "Failed to fread entire contents of shader: %s\n", filepath);
-		fclose(sourceFile);
-		return false;
-	}
-	
-	fclose(sourceFile);
-	
-	*shader = glCreateShader(type);
+	GLuint shader = glCreateShader(type);
 	
 	GLchar versionLine[256] = {0};
 	snprintf(versionLine, sizeof(versionLine) - 1, "#version %u\n", glslVersion);
-	glShaderSource(*shader, 2, (const GLchar *[]){versionLine, source}, (GLint []){(GLint)strlen(versionLine), fileSize});
+	glShaderSource(shader, 2, (const GLchar *[]){versionLine, source}, (GLint []){(GLint)strlen(versionLine), (GLint)strlen(source)});
 	
-	glCompileShader(*shader);
+	glCompileShader(shader);
 	
-	free(source);
+	return shader;
+}
+
+static bool finishCompilingShader(GLuint shader)
+{
+	GLint status;
 	
 #ifdef _DEBUG
 	GLint logLength;
-	glGetShaderiv(*shader, GL_INFO_LOG_LENGTH, &logLength);
+	glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
 	if (logLength > 1) // ignore just null terminator or useless log
 	{
 		GLchar *log = (GLchar *)malloc(logLength);
-		glGetShaderInfoLog(*shader, logLength, &logLength, log);
+		glGetShaderInfoLog(shader, logLength, &logLength, log);
 		fprintf(stderr, "Shader compiler log:\n%s\n", log);
 		free(log);
 	}
 #endif
 	
-	glGetShaderiv(*shader, GL_COMPILE_STATUS, &status);
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
 	if (status == 0)
 	{
-		glDeleteShader(*shader);
 		return false;
 	}
 	
 	return true;
 }
 
-static bool linkProgram(GLuint prog)
+static bool finishLinkingProgram(GLuint prog)
 {
 	GLint status;
-	glLinkProgram(prog);
 	
 #ifdef _DEBUG
 	GLint logLength;
@@ -149,22 +176,10 @@ static bool linkProgram(GLuint prog)
 	return true;
 }
 
-static void compileAndLinkShader(Shader_gl *shader, uint16_t glslVersion, const char *vertexShaderPath, const char *fragmentShaderPath, bool textured, const char *modelViewProjectionUniform, const char *colorUniform, const char *textureSampleUniform)
+static void beginCompilingAndLinkingProgram(ShaderCompilation_gl *compilation, uint16_t glslVersion)
 {
-	// Create a pair of shaders
-	GLuint vertexShader = 0;
-	if (!compileShader(&vertexShader, glslVersion, GL_VERTEX_SHADER, vertexShaderPath))
-	{
-		fprintf(stderr, "Error: Failed to compile vertex shader: %s..\n", vertexShaderPath);
-		ZGQuit();
-	}
-	
-	GLuint fragmentShader = 0;
-	if (!compileShader(&fragmentShader, glslVersion, GL_FRAGMENT_SHADER, fragmentShaderPath))
-	{
-		fprintf(stderr, "Error: Failed to compile fragment shader: %s..\n", fragmentShaderPath);
-		ZGQuit();
-	}
+	compilation->vertexShader = beginCompilingShader(glslVersion, GL_VERTEX_SHADER, compilation->vertexShaderSource);
+	compilation->fragmentShader = beginCompilingShader(glslVersion, GL_FRAGMENT_SHADER, compilation->fragmentShaderSource);
 	
 	GLuint shaderProgram = glCreateProgram();
 	if (shaderProgram == 0)
@@ -173,23 +188,83 @@ static void compileAndLinkShader(Shader_gl *shader, uint16_t glslVersion, const
 		ZGQuit();
 	}
 	
-	glAttachShader(shaderProgram, vertexShader);
-	glAttachShader(shaderProgram, fragmentShader);
+	glAttachShader(shaderProgram, compilation->vertexShader);
+	glAttachShader(shaderProgram, compilation->fragmentShader);
 	
 	glBindAttribLocation(shaderProgram, VERTEX_ATTRIBUTE, "position");
-	if (textured)
+	if (compilation->textured)
 	{
 		glBindAttribLocation(shaderProgram, TEXTURE_ATTRIBUTE, "textureCoordIn");
 	}
 	
+	if (compilation->instanced)
+	{
+		glBindAttribLocation(shaderProgram, INSTANCE_TRANSLATION_ATTRIBUTE, "instanceTranslation");
+		glBindAttribLocation(shaderProgram, INSTANCE_COLOR_ATTRIBUTE, "instanceColor");
+	}
+	
 	glBindFragDataLocation(shaderProgram, 0, "fragColor");
 	
-	if (!linkProgram(shaderProgram))
+	// Let the program be saved to our program cache
+	glProgramParameteri(shaderProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	
+	glLinkProgram(shaderProgram);
+	
+	compilation->program = shaderProgram;
+}
+
+static void finishCompilingAndLinkingProgram(ShaderCompilation_gl *compilation)
+{
+	if (!finishCompilingShader(compilation->vertexShader))
 	{
-		fprintf(stderr, "Failed to link shader program\n");
+		fprintf(stderr, "Error: Failed to compile vertex shader: %s..\n", compilation->shaderName);
 		ZGQuit();
 	}
 	
+	if (!finishCompilingShader(compilation->fragmentShader))
+	{
+		fprintf(stderr, "Error: Failed to compile fragment shader: %s..\n", compilation->shaderName);
+		ZGQuit();
+	}
+	
+	if (!finishLinkingProgram(compilation->program))
+	{
+		fprintf(stderr, "Failed to link shader program: %s\n", compilation->shaderName);
+		ZGQuit();
+	}
+	
+	glDetachShader(compilation->program, compilation->vertexShader);
+	glDeleteShader(compilation->vertexShader);
+	
+	glDetachShader(compilation->program, compilation->fragmentShader);
+	glDeleteShader(compilation->fragmentShader);
+}
+
+static void beginCompilingAndLinkingShader(ShaderCompilation_gl *compilation, ProgramCache *programCache, uint16_t glslVersion)
+{
+	compilation->programKey = programCacheKey(compilation->vertexShaderSource, compilation->fragmentShaderSource, glslVersion, compilation->textured, compilation->instanced);
+	
+	compilation->program = programFromCache(programCache, compilation->programKey);
+	compilation->cached = (compilation->program != 0);
+	if (!compilation->cached)
+	{
+		beginCompilingAndLinkingProgram(compilation, glslVersion);
+	}
+}
+
+static void finishCompilingAndLinkingShader(ShaderCompilation_gl *compilation, ProgramCache *programCache)
+{
+	if (!compilation->cached)
+	{
+		finishCompilingAndLinkingProgram(compilation);
+	}
+	
+	GLuint shaderProgram = compilation->program;
+	addProgramToCache(programCache, compilation->programKey, shaderProgram);
+	
+	Shader_gl *shader = compilation->shader;
+	
+	const char *modelViewProjectionUniform = compilation->modelViewProjectionUniform;
 	GLint modelViewProjectionMatrixUniformLocation = glGetUniformLocation(shaderProgram, modelViewProjectionUniform);
 	if (modelViewProjectionMatrixUniformLocation == -1)
 	{
@@ -198,16 +273,26 @@ static void compileAndLinkShader(Shader_gl *shader, uint16_t glslVersion, const
 	}
 	shader->modelViewProjectionMatrixUniformLocation = modelViewProjectionMatrixUniformLocation;
 	
-	GLint colorUniformLocation = glGetUniformLocation(shaderProgram, colorUniform);
-	if (colorUniformLocation == -1)
+	// Instanced shaders read their color from a vertex attribute instead
+	const char *colorUniform = compilation->colorUniform;
+	if (colorUniform != NULL)
 	{
-		fprintf(stderr, "Failed to find %s uniform\n", colorUniform);
-		ZGQuit();
+		GLint colorUniformLocation = glGetUniformLocation(shaderProgram, colorUniform);
+		if (colorUniformLocation == -1)
+		{
+			fprintf(stderr, "Failed to find %s uniform\n", colorUniform);
+			ZGQuit();
+		}
+		shader->colorUniformLocation = colorUniformLocation;
+	}
+	else
+	{
+		shader->colorUniformLocation = -1;
 	}
-	shader->colorUniformLocation = colorUniformLocation;
 	
-	if (textured)
+	if (compilation->textured)
 	{
+		const char *textureSampleUniform = compilation->textureSampleUniform;
 		GLint textureUniformLocation = glGetUniformLocation(shaderProgram, textureSampleUniform);
 		if (textureUniformLocation == -1)
 		{
@@ -215,15 +300,41 @@ static void compileAndLinkShader(Shader_gl *shader, uint16_t glslVersion, const
 			ZGQuit();
 		}
 		shader->textureUniformLocation = textureUniformLocation;
+		
+		// Textures are always bound to the first texture unit
+		glUseProgram(shaderProgram);
+		glUniform1i(textureUniformLocation, 0);
+		glUseProgram(0);
 	}
 	
+	shader->hasLastColor = false;
+	
 	shader->program = shaderProgram;
+}
+
+// Lets the driver compile shaders on as many threads as it likes when it offers GL_KHR_parallel_shader_compile
+static void enableParallelShaderCompilation(void)
+{
+	const char *functionName = NULL;
+	if (SDL_GL_ExtensionSupported("GL_KHR_parallel_shader_compile"))
+	{
+		functionName = "glMaxShaderCompilerThreadsKHR";
+	}
+	else if (SDL_GL_ExtensionSupported("GL_ARB_parallel_shader_compile"))
+	{
+		functionName = "glMaxShaderCompilerThreadsARB";
+	}
 	
-	glDetachShader(shaderProgram, vertexShader);
-	glDeleteShader(vertexShader);
+	if (functionName == NULL)
+	{
+		return;
+	}
 	
-	glDetachShader(shaderProgram, fragmentShader);
-	glDeleteShader(fragmentShader);
+	MaxShaderCompilerThreadsFunction_gl maxShaderCompilerThreads = (MaxShaderCompilerThreadsFunction_gl)SDL_GL_GetProcAddress(functionName);
+	if (maxShaderCompilerThreads != NULL)
+	{
+		maxShaderCompilerThreads(MAX_SHADER_COMPILER_THREADS_UNLIMITED);
+	}
 }
 
 static bool createOpenGLContext(ZGWindow **window, SDL_GLContext *glContext, uint16_t glslVersion, const char *windowTitle, int32_t windowWidth, int32_t windowHeight, bool *fullscreenFlag, bool fsaa)
@@ -292,6 +403,52 @@ static bool createOpenGLContext(ZGWindow **window, SDL_GLContext *glContext, uin
 	return true;
 }
 
+static void createTextureQuadBuffers(Renderer *renderer)
+{
+	GLuint vertexArray = 0;
+	glGenVertexArrays(1, &vertexArray);
+	glBindVertexArray(vertexArray);
+	
+	// Vertex data is streamed into this buffer on every texture quads draw
+	GLuint vertexBuffer = 0;
+	glGenBuffers(1, &vertexBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+	
+	glEnableVertexAttribArray(VERTEX_ATTRIBUTE);
+	glVertexAttribPointer(VERTEX_ATTRIBUTE, 4, GL_FLOAT, GL_FALSE, sizeof(RendererTextureVertex), (GLvoid *)offsetof(RendererTextureVertex, position));
+	
+	glEnableVertexAttribArray(TEXTURE_ATTRIBUTE);
+	glVertexAttribPointer(TEXTURE_ATTRIBUTE, 2, GL_FLOAT, GL_FALSE, sizeof(RendererTextureVertex), (GLvoid *)offsetof(RendererTextureVertex, textureCoordinate));
+	
+	// Every quad uses the same winding, so the indices for a full batch only need to be uploaded once
+	uint16_t indices[MAX_TEXTURE_QUAD_BATCH_COUNT * 6];
+	for (uint16_t quadIndex = 0; quadIndex < MAX_TEXTURE_QUAD_BATCH_COUNT; quadIndex++)
+	{
+		uint16_t baseVertex = quadIndex * 4;
+		uint16_t *quadIndices = &indices[quadIndex * 6];
+		
+		quadIndices[0] = baseVertex + 0;
+		quadIndices[1] = baseVertex + 1;
+		quadIndices[2] = baseVertex + 2;
+		quadIndices[3] = baseVertex + 2;
+		quadIndices[4] = baseVertex + 3;
+		quadIndices[5] = baseVertex + 0;
+	}
+	
+	// The element array buffer binding is recorded into the vertex array object
+	GLuint indexBuffer = 0;
+	glGenBuffers(1, &indexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+	
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	
+	renderer->glTextureQuadVertexArray = vertexArray;
+	renderer->glTextureQuadVertexBuffer = vertexBuffer;
+	renderer->glTextureQuadIndexBuffer = indexBuffer;
+}
+
 static void updateViewport_gl(Renderer *renderer, int32_t windowWidth, int32_t windowHeight)
 {
 	if (!ZGWindowIsFullscreen(renderer->window) && !renderer->fullscreen)
@@ -325,6 +482,8 @@ void createRenderer_gl(Renderer *renderer, RendererCreateOptions options)
 		fprintf(stderr, "Failed to create OpenGL context with glsl version %d\n", glslVersion);
 		ZGQuit();
 	}
+	
+	markLaunchPhase("OpenGL context creation");
 
 	if (!SDL_GL_MakeCurrent(ZGWindowHandle(renderer->window), glContext))
 	{
@@ -358,6 +517,8 @@ void createRenderer_gl(Renderer *renderer, RendererCreateOptions options)
 		ZGQuit();
 	}
 	
+	markLaunchPhase("OpenGL context setup & glad loading");
+	
 	int value;
 	SDL_GL_GetAttribute(SDL_GL_MULTISAMPLEBUFFERS, &value);
 	renderer->fsaa = (value != 0);
@@ -394,9 +555,46 @@ void createRenderer_gl(Renderer *renderer, RendererCreateOptions options)
 		glEnable(GL_MULTISAMPLE);
 	}
 	
-	compileAndLinkShader(&renderer->glPositionShader, glslVersion, "Data/Shaders/position.vsh", "Data/Shaders/position.fsh", false, "modelViewProjectionMatrix", "color", NULL);
+	glActiveTexture(GL_TEXTURE0);
+	
+	markLaunchPhase("OpenGL state setup");
+	
+	ProgramCache *programCache = (options.programCacheDefaultsName != NULL) ? loadProgramCache(options.programCacheDefaultsName) : NULL;
+	
+	enableParallelShaderCompilation();
+	
+	ShaderCompilation_gl shaderCompilations[] =
+	{
+		{.shader = &renderer->glPositionShader, .shaderName = "position", .vertexShaderSource = gPositionVertexShaderSource, .fragmentShaderSource = gPositionFragmentShaderSource, .modelViewProjectionUniform = "modelViewProjectionMatrix", .colorUniform = "color"},
+		{.shader = &renderer->glPositionTextureShader, .shaderName = "texture-position", .vertexShaderSource = gTexturePositionVertexShaderSource, .fragmentShaderSource = gTexturePositionFragmentShaderSource, .modelViewProjectionUniform = "modelViewProjectionMatrix", .colorUniform = "color", .textureSampleUniform = "textureSample", .textured = true},
+		{.shader = &renderer->glPositionTextureDistanceFieldShader, .shaderName = "texture-position-distance-field", .vertexShaderSource = gTexturePositionVertexShaderSource, .fragmentShaderSource = gTexturePositionDistanceFieldFragmentShaderSource, .modelViewProjectionUniform = "modelViewProjectionMatrix", .colorUniform = "color", .textureSampleUniform = "textureSample", .textured = true},
+		{.shader = &renderer->glPositionInstancedShader, .shaderName = "position-instanced", .vertexShaderSource = gPositionInstancedVertexShaderSource, .fragmentShaderSource = gPositionInstancedFragmentShaderSource, .modelViewProjectionUniform = "modelViewProjectionMatrix", .instanced = true}
+	};
+	const size_t shaderCompilationCount = sizeof(shaderCompilations) / sizeof(*shaderCompilations);
+	
+	for (size_t compilationIndex = 0; compilationIndex < shaderCompilationCount; compilationIndex++)
+	{
+		beginCompilingAndLinkingShader(&shaderCompilations[compilationIndex], programCache, glslVersion);
+	}
+	
+	// Create our buffers while the shaders are being compiled
+	// Instance data is streamed into this buffer on every instanced draw
+	GLuint instanceBuffer = 0;
+	glGenBuffers(1, &instanceBuffer);
+	renderer->glInstanceBuffer = instanceBuffer;
+	
+	createTextureQuadBuffers(renderer);
+	
+	for (size_t compilationIndex = 0; compilationIndex < shaderCompilationCount; compilationIndex++)
+	{
+		finishCompilingAndLinkingShader(&shaderCompilations[compilationIndex], programCache);
+	}
+	
+	saveProgramCache(programCache);
 	
-	compileAndLinkShader(&renderer->glPositionTextureShader, glslVersion, "Data/Shaders/texture-position.vsh", "Data/Shaders/texture-position.fsh", true, "modelViewProjectionMatrix", "color", "textureSample");
+	markLaunchPhase("shader compilation");
+	
+	resetStateCache(renderer);
 	
 	renderer->updateViewportPtr = updateViewport_gl;
 	renderer->renderFramePtr = renderFrame_gl;
@@ -407,10 +605,13 @@ void createRenderer_gl(Renderer *renderer, RendererCreateOptions options)
 	renderer->createVertexAndTextureCoordinateArrayObjectPtr = createVertexAndTextureCoordinateArrayObject_gl;
 	renderer->drawVerticesPtr = drawVertices_gl;
 	renderer->drawVerticesFromIndicesPtr = drawVerticesFromIndices_gl;
+	renderer->drawVerticesFromIndicesInstancedPtr = drawVerticesFromIndicesInstanced_gl;
 	renderer->drawTextureWithVerticesPtr = drawTextureWithVertices_gl;
 	renderer->drawTextureWithVerticesFromIndicesPtr = drawTextureWithVerticesFromIndices_gl;
+	renderer->drawTextureQuadsPtr = drawTextureQuads_gl;
 	renderer->pushDebugGroupPtr = pushDebugGroup_gl;
 	renderer->popDebugGroupPtr = popDebugGroup_gl;
+	renderer->reportStatisticsPtr = reportStatistics_gl;
 
 	// Set window & keyboard handlers
 	ZGSetWindowEventHandler(renderer->window, options.windowEventContext, options.windowEventHandler);
@@ -419,6 +620,11 @@ void createRenderer_gl(Renderer *renderer, RendererCreateOptions options)
 
 void renderFrame_gl(Renderer *renderer, void (*drawFunc)(Renderer *, void *), void *context)
 {
+	renderer->glRenderedFrameCount++;
+	
+	// Don't trust state that may have been changed outside of our draw calls
+	resetStateCache(renderer);
+	
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	
 	drawFunc(renderer, context);
@@ -451,6 +657,7 @@ static GLuint glTextureFromPixelData(Renderer *renderer, const void *pixels, int
 	
 	glGenTextures(1, &texture);
 	glBindTexture(GL_TEXTURE_2D, texture);
+	renderer->glLastTexture = texture;
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexImage2D(GL_TEXTURE_2D,
@@ -474,6 +681,25 @@ TextureObject textureFromPixelData_gl(Renderer *renderer, const void *pixels, in
 void deleteTexture_gl(Renderer *renderer, TextureObject texture)
 {
 	glDeleteTextures(1, &texture.glObject);
+	
+	// Deleting a bound texture reverts the binding to zero
+	if (renderer->glLastTexture == texture.glObject)
+	{
+		renderer->glLastTexture = 0;
+	}
+}
+
+static void reportStatistics_gl(Renderer *renderer)
+{
+	uint64_t frameCount = renderer->glRenderedFrameCount;
+	if (frameCount == 0)
+	{
+		fprintf(stderr, "GL state cache: no frames were rendered\n");
+		return;
+	}
+	
+	uint64_t stateChangeCount = renderer->glStateChangesIssued + renderer->glStateChangesSkipped;
+	fprintf(stderr, "GL state cache: %llu frames, %.1f state changes issued and %.1f skipped per frame (%.1f%% skipped)\n", (unsigned long long)frameCount, renderer->glStateChangesIssued / (double)frameCount, renderer->glStateChangesSkipped / (double)frameCount, (stateChangeCount > 0) ? 100.0 * renderer->glStateChangesSkipped / (double)stateChangeCount : 0.0);
 }
 
 static GLenum glModeFromMode(RendererMode mode)
@@ -522,6 +748,9 @@ BufferArrayObject createVertexArrayObject_gl(Renderer *renderer, const void *ver
 	glBindVertexArray(0);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	
+	renderer->glLastVertexArray = 0;
+	renderer->glLastElementArrayBuffer = GL_STATE_CACHE_UNKNOWN;
+	
 	return (BufferArrayObject){.glObject = vertexArray};
 }
 
@@ -545,111 +774,266 @@ BufferArrayObject createVertexAndTextureCoordinateArrayObject_gl(Renderer *rende
 	glBindVertexArray(0);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	
+	renderer->glLastVertexArray = 0;
+	renderer->glLastElementArrayBuffer = GL_STATE_CACHE_UNKNOWN;
+	
 	return (BufferArrayObject){.glObject = vertexArray};
 }
 
-static void beginDrawingVertices(Shader_gl *shader, BufferArrayObject vertexArrayObject, RendererOptions options)
+static void resetStateCache(Renderer *renderer)
+{
+	renderer->glLastProgram = GL_STATE_CACHE_UNKNOWN;
+	renderer->glLastVertexArray = GL_STATE_CACHE_UNKNOWN;
+	renderer->glLastElementArrayBuffer = GL_STATE_CACHE_UNKNOWN;
+	renderer->glLastTexture = GL_STATE_CACHE_UNKNOWN;
+	renderer->glLastBlendMode = GL_STATE_CACHE_UNKNOWN;
+	
+	renderer->glPositionShader.hasLastColor = false;
+	renderer->glPositionTextureShader.hasLastColor = false;
+	renderer->glPositionTextureDistanceFieldShader.hasLastColor = false;
+	renderer->glPositionInstancedShader.hasLastColor = false;
+}
+
+static void useProgram(Renderer *renderer, Shader_gl *shader)
+{
+	if (renderer->glLastProgram == (uint32_t)shader->program)
+	{
+		renderer->glStateChangesSkipped++;
+		return;
+	}
+	
+	glUseProgram(shader->program);
+	renderer->glLastProgram = (uint32_t)shader->program;
+	renderer->glStateChangesIssued++;
+}
+
+static void bindVertexArray(Renderer *renderer, BufferArrayObject vertexArrayObject)
 {
-	bool blendingAlpha = (options & RENDERER_OPTION_BLENDING_ALPHA) != 0;
-	bool blendingOneMinusAlpha = (options & RENDERER_OPTION_BLENDING_ONE_MINUS_ALPHA) != 0;
-	bool blending = (blendingAlpha || blendingOneMinusAlpha);
-	if (blending)
+	if (renderer->glLastVertexArray == vertexArrayObject.glObject)
+	{
+		renderer->glStateChangesSkipped++;
+		return;
+	}
+	
+	glBindVertexArray(vertexArrayObject.glObject);
+	renderer->glLastVertexArray = vertexArrayObject.glObject;
+	// The element array buffer binding is part of the vertex array object's state
+	renderer->glLastElementArrayBuffer = GL_STATE_CACHE_UNKNOWN;
+	renderer->glStateChangesIssued++;
+}
+
+static void bindElementArrayBuffer(Renderer *renderer, BufferObject indicesBufferObject)
+{
+	if (renderer->glLastElementArrayBuffer == indicesBufferObject.glObject)
+	{
+		renderer->glStateChangesSkipped++;
+		return;
+	}
+	
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indicesBufferObject.glObject);
+	renderer->glLastElementArrayBuffer = indicesBufferObject.glObject;
+	renderer->glStateChangesIssued++;
+}
+
+static void bindTexture(Renderer *renderer, TextureObject texture)
+{
+	if (renderer->glLastTexture == texture.glObject)
+	{
+		renderer->glStateChangesSkipped++;
+		return;
+	}
+	
+	glBindTexture(GL_TEXTURE_2D, texture.glObject);
+	renderer->glLastTexture = texture.glObject;
+	renderer->glStateChangesIssued++;
+}
+
+static void setBlendMode(Renderer *renderer, RendererOptions options)
+{
+	uint32_t blendMode;
+	if ((options & RENDERER_OPTION_BLENDING_ALPHA) != 0)
+	{
+		blendMode = RENDERER_OPTION_BLENDING_ALPHA;
+	}
+	else if ((options & RENDERER_OPTION_BLENDING_ONE_MINUS_ALPHA) != 0)
+	{
+		blendMode = RENDERER_OPTION_BLENDING_ONE_MINUS_ALPHA;
+	}
+	else
 	{
-		glEnable(GL_BLEND);
+		blendMode = RENDERER_OPTION_NONE;
+	}
+	
+	uint32_t lastBlendMode = renderer->glLastBlendMode;
+	if (lastBlendMode == blendMode)
+	{
+		renderer->glStateChangesSkipped++;
+		return;
+	}
+	
+	if (blendMode == RENDERER_OPTION_NONE)
+	{
+		glDisable(GL_BLEND);
+		renderer->glStateChangesIssued++;
+	}
+	else
+	{
+		if (lastBlendMode == RENDERER_OPTION_NONE || lastBlendMode == GL_STATE_CACHE_UNKNOWN)
+		{
+			glEnable(GL_BLEND);
+			renderer->glStateChangesIssued++;
+		}
 		
-		if (blendingAlpha)
+		if (blendMode == RENDERER_OPTION_BLENDING_ALPHA)
 		{
 			glBlendFunc(GL_SRC_ALPHA, GL_SRC_ALPHA);
 		}
-		else /* if (blendingOneMinusAlpha) */
+		else /* if (blendMode == RENDERER_OPTION_BLENDING_ONE_MINUS_ALPHA) */
 		{
 			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 		}
+		renderer->glStateChangesIssued++;
 	}
 	
-	glBindVertexArray(vertexArrayObject.glObject);
-	
-	glUseProgram(shader->program);
+	renderer->glLastBlendMode = blendMode;
 }
 
-static void setModelViewProjectionAndColorUniforms(Shader_gl *shader, float *modelViewProjectionMatrix, color4_t color)
+static void beginDrawingVertices(Renderer *renderer, Shader_gl *shader, BufferArrayObject vertexArrayObject, RendererOptions options)
 {
-	glUniformMatrix4fv(shader->modelViewProjectionMatrixUniformLocation, 1, GL_FALSE, modelViewProjectionMatrix);
-	glUniform4f(shader->colorUniformLocation, color.red, color.green, color.blue, color.alpha);
+	setBlendMode(renderer, options);
+	
+	bindVertexArray(renderer, vertexArrayObject);
+	
+	useProgram(renderer, shader);
 }
 
-static void endDrawingVerticesAndTextures(RendererOptions options)
+static void setModelViewProjectionAndColorUniforms(Renderer *renderer, Shader_gl *shader, float *modelViewProjectionMatrix, color4_t color)
 {
-	glBindVertexArray(0);
+	glUniformMatrix4fv(shader->modelViewProjectionMatrixUniformLocation, 1, GL_FALSE, modelViewProjectionMatrix);
 	
-	bool blendingAlpha = (options & RENDERER_OPTION_BLENDING_ALPHA) != 0;
-	bool blendingOneMinusAlpha = (options & RENDERER_OPTION_BLENDING_ONE_MINUS_ALPHA) != 0;
-	bool blending = (blendingAlpha || blendingOneMinusAlpha);
-	if (blending)
+	// Uniform values are retained by their program, so the color only needs to be uploaded when it differs
+	if (shader->hasLastColor && memcmp(&shader->lastColor, &color, sizeof(color)) == 0)
 	{
-		glDisable(GL_BLEND);
+		renderer->glStateChangesSkipped++;
+		return;
 	}
+	
+	glUniform4f(shader->colorUniformLocation, color.red, color.green, color.blue, color.alpha);
+	shader->lastColor = color;
+	shader->hasLastColor = true;
+	renderer->glStateChangesIssued++;
 }
 
 void drawVertices_gl(Renderer *renderer, float *modelViewProjectionMatrix, RendererMode mode, BufferArrayObject vertexArrayObject, uint32_t vertexCount, color4_t color, RendererOptions options)
 {
-	beginDrawingVertices(&renderer->glPositionShader, vertexArrayObject, options);
+	beginDrawingVertices(renderer, &renderer->glPositionShader, vertexArrayObject, options);
 	
-	setModelViewProjectionAndColorUniforms(&renderer->glPositionShader, modelViewProjectionMatrix, color);
+	setModelViewProjectionAndColorUniforms(renderer, &renderer->glPositionShader, modelViewProjectionMatrix, color);
 	
 	glDrawArrays(glModeFromMode(mode), 0, vertexCount);
-	
-	endDrawingVerticesAndTextures(options);
 }
 
 void drawVerticesFromIndices_gl(Renderer *renderer, float *modelViewProjectionMatrix, RendererMode mode, BufferArrayObject vertexArrayObject, BufferObject indicesBufferObject, uint32_t indicesCount, color4_t color, RendererOptions options)
 {
-	beginDrawingVertices(&renderer->glPositionShader, vertexArrayObject, options);
+	beginDrawingVertices(renderer, &renderer->glPositionShader, vertexArrayObject, options);
 	
-	setModelViewProjectionAndColorUniforms(&renderer->glPositionShader, modelViewProjectionMatrix, color);
+	setModelViewProjectionAndColorUniforms(renderer, &renderer->glPositionShader, modelViewProjectionMatrix, color);
 	
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indicesBufferObject.glObject);
+	bindElementArrayBuffer(renderer, indicesBufferObject);
 	
 	glDrawElements(glModeFromMode(mode), indicesCount, GL_UNSIGNED_SHORT, NULL);
+}
+
+void drawVerticesFromIndicesInstanced_gl(Renderer *renderer, float *modelViewProjectionMatrix, RendererMode mode, BufferArrayObject vertexArrayObject, BufferObject indicesBufferObject, uint32_t indicesCount, const RendererInstance *instances, uint32_t instanceCount, RendererOptions options)
+{
+	Shader_gl *shader = &renderer->glPositionInstancedShader;
 	
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	beginDrawingVertices(renderer, shader, vertexArrayObject, options);
 	
-	endDrawingVerticesAndTextures(options);
+	glUniformMatrix4fv(shader->modelViewProjectionMatrixUniformLocation, 1, GL_FALSE, modelViewProjectionMatrix);
+	
+	GLsizeiptr instancesSize = (GLsizeiptr)(instanceCount * sizeof(*instances));
+	
+	glBindBuffer(GL_ARRAY_BUFFER, renderer->glInstanceBuffer);
+	// Orphan the buffer's previous storage so we don't have to wait on draws still reading from it
+	glBufferData(GL_ARRAY_BUFFER, instancesSize, NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, instancesSize, instances);
+	
+	// The instance attributes are recorded into the bound vertex array object
+	glEnableVertexAttribArray(INSTANCE_TRANSLATION_ATTRIBUTE);
+	glVertexAttribPointer(INSTANCE_TRANSLATION_ATTRIBUTE, 3, GL_FLOAT, GL_FALSE, sizeof(*instances), (GLvoid *)offsetof(RendererInstance, translation));
+	glVertexAttribDivisor(INSTANCE_TRANSLATION_ATTRIBUTE, 1);
+	
+	glEnableVertexAttribArray(INSTANCE_COLOR_ATTRIBUTE);
+	glVertexAttribPointer(INSTANCE_COLOR_ATTRIBUTE, 4, GL_FLOAT, GL_FALSE, sizeof(*instances), (GLvoid *)offsetof(RendererInstance, color));
+	glVertexAttribDivisor(INSTANCE_COLOR_ATTRIBUTE, 1);
+	
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	
+	bindElementArrayBuffer(renderer, indicesBufferObject);
+	
+	glDrawElementsInstanced(glModeFromMode(mode), indicesCount, GL_UNSIGNED_SHORT, NULL, (GLsizei)instanceCount);
 }
 
-static void beginDrawingTexture(Shader_gl *shader, TextureObject texture, BufferArrayObject vertexAndTextureArrayObject, RendererOptions options)
+static void beginDrawingTexture(Renderer *renderer, Shader_gl *shader, TextureObject texture, BufferArrayObject vertexAndTextureArrayObject, RendererOptions options)
 {
-	beginDrawingVertices(shader, vertexAndTextureArrayObject, options);
+	beginDrawingVertices(renderer, shader, vertexAndTextureArrayObject, options);
 	
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, texture.glObject);
-	glUniform1i(shader->textureUniformLocation, 0);
+	// The texture unit and sampler uniform never change, so only the texture binding needs updating
+	bindTexture(renderer, texture);
 }
 
 void drawTextureWithVertices_gl(Renderer *renderer, float *modelViewProjectionMatrix, TextureObject texture, RendererMode mode, BufferArrayObject vertexAndTextureArrayObject, uint32_t vertexCount, color4_t color, RendererOptions options)
 {
-	beginDrawingTexture(&renderer->glPositionTextureShader, texture, vertexAndTextureArrayObject, options);
+	beginDrawingTexture(renderer, &renderer->glPositionTextureShader, texture, vertexAndTextureArrayObject, options);
 	
-	setModelViewProjectionAndColorUniforms(&renderer->glPositionTextureShader, modelViewProjectionMatrix, color);
+	setModelViewProjectionAndColorUniforms(renderer, &renderer->glPositionTextureShader, modelViewProjectionMatrix, color);
 	
 	glDrawArrays(glModeFromMode(mode), 0, vertexCount);
-	
-	endDrawingVerticesAndTextures(options);
 }
 
 void drawTextureWithVerticesFromIndices_gl(Renderer *renderer, float *modelViewProjectionMatrix, TextureObject texture, RendererMode mode, BufferArrayObject vertexAndTextureArrayObject, BufferObject indicesBufferObject, uint32_t indicesCount, color4_t color, RendererOptions options)
 {
-	beginDrawingTexture(&renderer->glPositionTextureShader, texture, vertexAndTextureArrayObject, options);
+	beginDrawingTexture(renderer, &renderer->glPositionTextureShader, texture, vertexAndTextureArrayObject, options);
 	
-	setModelViewProjectionAndColorUniforms(&renderer->glPositionTextureShader, modelViewProjectionMatrix, color);
+	setModelViewProjectionAndColorUniforms(renderer, &renderer->glPositionTextureShader, modelViewProjectionMatrix, color);
 	
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indicesBufferObject.glObject);
+	bindElementArrayBuffer(renderer, indicesBufferObject);
 	
 	glDrawElements(glModeFromMode(mode), indicesCount, GL_UNSIGNED_SHORT, NULL);
+}
+
+void drawTextureQuads_gl(Renderer *renderer, float *modelViewProjectionMatrix, TextureObject texture, const RendererTextureVertex *vertices, uint32_t quadCount, color4_t color, RendererOptions options)
+{
+	Shader_gl *shader = ((options & RENDERER_OPTION_DISTANCE_FIELD) != 0) ? &renderer->glPositionTextureDistanceFieldShader : &renderer->glPositionTextureShader;
+	
+	beginDrawingTexture(renderer, shader, texture, (BufferArrayObject){.glObject = renderer->glTextureQuadVertexArray}, options);
+	
+	setModelViewProjectionAndColorUniforms(renderer, shader, modelViewProjectionMatrix, color);
 	
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	// Our index buffer is bound by the vertex array object
+	renderer->glLastElementArrayBuffer = renderer->glTextureQuadIndexBuffer;
+	
+	glBindBuffer(GL_ARRAY_BUFFER, renderer->glTextureQuadVertexBuffer);
+	
+	for (uint32_t quadOffset = 0; quadOffset < quadCount; quadOffset += MAX_TEXTURE_QUAD_BATCH_COUNT)
+	{
+		uint32_t batchCount = quadCount - quadOffset;
+		if (batchCount > MAX_TEXTURE_QUAD_BATCH_COUNT)
+		{
+			batchCount = MAX_TEXTURE_QUAD_BATCH_COUNT;
+		}
+		
+		GLsizeiptr verticesSize = (GLsizeiptr)(batchCount * 4 * sizeof(*vertices));
+		
+		// Orphan the buffer's previous storage so we don't have to wait on draws still reading from it
+		glBufferData(GL_ARRAY_BUFFER, verticesSize, NULL, GL_STREAM_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, verticesSize, &vertices[quadOffset * 4]);
+		
+		glDrawElements(GL_TRIANGLES, (GLsizei)(batchCount * 6), GL_UNSIGNED_SHORT, NULL);
+	}
 	
-	endDrawingVerticesAndTextures(options);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 void pushDebugGroup_gl(Renderer *renderer, const char *groupName)
@@ -69,6 +69,10 @@ typedef struct
 #endif
 
 	const char* windowTitle;
+	
+	// Name of the user data directory to cache compiled shader programs in, or NULL to not cache them
+	// Only used by the GL renderer
+	const char* programCacheDefaultsName;
     
     color4_t clearColor;
 
@@ -85,7 +89,9 @@ typedef enum
 {
 	RENDERER_OPTION_NONE = 0,
 	RENDERER_OPTION_BLENDING_ALPHA = (1 << 0),
-	RENDERER_OPTION_BLENDING_ONE_MINUS_ALPHA = (1 << 1)
+	RENDERER_OPTION_BLENDING_ONE_MINUS_ALPHA = (1 << 1),
+	// The texture's alpha holds a signed distance field with edges at 0.5 (only supported by drawTextureQuads)
+	RENDERER_OPTION_DISTANCE_FIELD = (1 << 2)
 } RendererOptions;
 
 typedef enum
@@ -145,6 +151,22 @@ typedef struct
 	};
 } TextureObject;
 
+// Per-instance data for instanced draws
+// The translation is applied to each vertex before the model-view-projection matrix
+typedef struct
+{
+	ZGFloat translation[3];
+	color4_t color;
+} RendererInstance;
+
+// Vertex for textured quads that are streamed to the renderer on every draw, such as glyphs from a text atlas
+// Quads are passed as 4 consecutive vertices in the same winding as a rectangle index buffer
+typedef struct
+{
+	ZGFloat position[4];
+	ZGFloat textureCoordinate[2];
+} RendererTextureVertex;
+
 typedef enum
 {
 	PIXEL_FORMAT_RGBA32,
@@ -159,6 +181,10 @@ typedef struct
 	int32_t modelViewProjectionMatrixUniformLocation;
 	int32_t colorUniformLocation;
 	int32_t textureUniformLocation;
+	
+	// Last color uploaded to this program's color uniform
+	color4_t lastColor;
+	bool hasLastColor;
 } Shader_gl;
 #elif PLATFORM_WINDOWS
 typedef struct
@@ -200,7 +226,25 @@ typedef struct _Renderer
 		struct
 		{
 			Shader_gl glPositionTextureShader;
+			Shader_gl glPositionTextureDistanceFieldShader;
 			Shader_gl glPositionShader;
+			Shader_gl glPositionInstancedShader;
+			uint32_t glInstanceBuffer;
+			uint32_t glTextureQuadVertexArray;
+			uint32_t glTextureQuadVertexBuffer;
+			uint32_t glTextureQuadIndexBuffer;
+			
+			// Shadow of the GL state set by our draw calls so redundant changes can be skipped
+			uint32_t glLastProgram;
+			uint32_t glLastVertexArray;
+			uint32_t glLastElementArrayBuffer;
+			uint32_t glLastTexture;
+			uint32_t glLastBlendMode;
+			
+			// Totals over every rendered frame, reported by reportRendererStatistics()
+			uint64_t glStateChangesIssued;
+			uint64_t glStateChangesSkipped;
+			uint64_t glRenderedFrameCount;
 		};
 #elif PLATFORM_APPLE
 		// Private metal data
@@ -254,10 +298,16 @@ typedef struct _Renderer
 	BufferArrayObject(*createVertexAndTextureCoordinateArrayObjectPtr)(struct _Renderer *, const void *, uint32_t, uint32_t);
 	void(*drawVerticesPtr)(struct _Renderer *, ZGFloat *, RendererMode, BufferArrayObject, uint32_t, color4_t, RendererOptions);
 	void(*drawVerticesFromIndicesPtr)(struct _Renderer *, ZGFloat *, RendererMode, BufferArrayObject, BufferObject, uint32_t, color4_t, RendererOptions);
+	// Optional; renderers that leave this NULL fall back to one draw per instance
+	void(*drawVerticesFromIndicesInstancedPtr)(struct _Renderer *, ZGFloat *, RendererMode, BufferArrayObject, BufferObject, uint32_t, const RendererInstance *, uint32_t, RendererOptions);
 	void(*drawTextureWithVerticesPtr)(struct _Renderer *, ZGFloat *, TextureObject, RendererMode, BufferArrayObject, uint32_t, color4_t, RendererOptions);
 	void(*drawTextureWithVerticesFromIndicesPtr)(struct _Renderer *, ZGFloat *, TextureObject, RendererMode, BufferArrayObject, BufferObject, uint32_t, color4_t, RendererOptions);
+	// Optional; renderers that leave this NULL do not support drawing streamed texture quads
+	void(*drawTextureQuadsPtr)(struct _Renderer *, ZGFloat *, TextureObject, const RendererTextureVertex *, uint32_t, color4_t, RendererOptions);
 	void(*pushDebugGroupPtr)(struct _Renderer *, const char *);
 	void(*popDebugGroupPtr)(struct _Renderer *);
+	// Optional; renderers that leave this NULL have no statistics to report
+	void(*reportStatisticsPtr)(struct _Renderer *);
 } Renderer;
 
 #ifdef __cplusplus
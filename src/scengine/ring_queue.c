@@ -0,0 +1,226 @@
+/*
+ MIT License
+
+ Copyright (c) 2024 Mayur Pawashe
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#include "ring_queue.h"
+#include "thread.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Keeps the producer and consumer indices on separate cache lines so they don't bounce between cores
+#define RING_QUEUE_CACHE_LINE_SIZE 64
+
+// Indices count up forever and wrap around at 2^32; only their differences and the low bits are used
+struct _SPSCQueue
+{
+	ZGAtomicInt head;
+	uint8_t headPadding[RING_QUEUE_CACHE_LINE_SIZE - sizeof(ZGAtomicInt)];
+	ZGAtomicInt tail;
+	uint8_t tailPadding[RING_QUEUE_CACHE_LINE_SIZE - sizeof(ZGAtomicInt)];
+	
+	uint32_t capacity;
+	size_t elementSize;
+	uint8_t *elements;
+};
+
+// Each slot has a sequence number telling whose turn it is (a bounded queue as described by Dmitry Vyukov)
+// A slot at position p is free for the producer claiming p when its sequence is p,
+// and holds a finished element for the consumer when its sequence is p + 1
+struct _MPSCQueue
+{
+	ZGAtomicInt tail;
+	uint8_t tailPadding[RING_QUEUE_CACHE_LINE_SIZE - sizeof(ZGAtomicInt)];
+	// Only touched by the consumer
+	uint32_t head;
+	uint8_t headPadding[RING_QUEUE_CACHE_LINE_SIZE - sizeof(uint32_t)];
+	
+	uint32_t capacity;
+	size_t elementSize;
+	ZGAtomicInt *sequences;
+	uint8_t *elements;
+};
+
+static uint32_t ringQueueCapacity(uint32_t requestedCapacity)
+{
+	uint32_t capacity = 1;
+	while (capacity < requestedCapacity && capacity < (1u << 30))
+	{
+		capacity <<= 1;
+	}
+	return capacity;
+}
+
+SPSCQueue *createSPSCQueue(uint32_t capacity, size_t elementSize)
+{
+	SPSCQueue *queue = calloc(1, sizeof(*queue));
+	if (queue == NULL)
+	{
+		fprintf(stderr, "Failed to allocate SPSC queue\n");
+		return NULL;
+	}
+	
+	queue->capacity = ringQueueCapacity(capacity);
+	queue->elementSize = elementSize;
+	queue->elements = calloc(queue->capacity, elementSize);
+	if (queue->elements == NULL)
+	{
+		fprintf(stderr, "Failed to allocate SPSC queue elements\n");
+		free(queue);
+		return NULL;
+	}
+	
+	return queue;
+}
+
+void destroySPSCQueue(SPSCQueue *queue)
+{
+	if (queue == NULL)
+	{
+		return;
+	}
+	
+	free(queue->elements);
+	free(queue);
+}
+
+bool pushSPSCQueue(SPSCQueue *queue, const void *element)
+{
+	uint32_t tail = (uint32_t)ZGAtomicLoad(&queue->tail);
+	uint32_t head = (uint32_t)ZGAtomicLoad(&queue->head);
+	if (tail - head >= queue->capacity)
+	{
+		return false;
+	}
+	
+	memcpy(queue->elements + (size_t)(tail & (queue->capacity - 1)) * queue->elementSize, element, queue->elementSize);
+	
+	// Publishing the new tail is what hands the element over
+	ZGAtomicStore(&queue->tail, (int32_t)(tail + 1));
+	return true;
+}
+
+bool popSPSCQueue(SPSCQueue *queue, void *element)
+{
+	uint32_t head = (uint32_t)ZGAtomicLoad(&queue->head);
+	uint32_t tail = (uint32_t)ZGAtomicLoad(&queue->tail);
+	if (head == tail)
+	{
+		return false;
+	}
+	
+	memcpy(element, queue->elements + (size_t)(head & (queue->capacity - 1)) * queue->elementSize, queue->elementSize);
+	
+	// The slot can only be reused once the new head is published
+	ZGAtomicStore(&queue->head, (int32_t)(head + 1));
+	return true;
+}
+
+MPSCQueue *createMPSCQueue(uint32_t capacity, size_t elementSize)
+{
+	MPSCQueue *queue = calloc(1, sizeof(*queue));
+	if (queue == NULL)
+	{
+		fprintf(stderr, "Failed to allocate MPSC queue\n");
+		return NULL;
+	}
+	
+	queue->capacity = ringQueueCapacity(capacity);
+	queue->elementSize = elementSize;
+	queue->sequences = calloc(queue->capacity, sizeof(*queue->sequences));
+	queue->elements = calloc(queue->capacity, elementSize);
+	if (queue->sequences == NULL || queue->elements == NULL)
+	{
+		fprintf(stderr, "Failed to allocate MPSC queue elements\n");
+		free(queue->sequences);
+		free(queue->elements);
+		free(queue);
+		return NULL;
+	}
+	
+	for (uint32_t slotIndex = 0; slotIndex < queue->capacity; slotIndex++)
+	{
+		ZGAtomicStore(&queue->sequences[slotIndex], (int32_t)slotIndex);
+	}
+	
+	return queue;
+}
+
+void destroyMPSCQueue(MPSCQueue *queue)
+{
+	if (queue == NULL)
+	{
+		return;
+	}
+	
+	free(queue->sequences);
+	free(queue->elements);
+	free(queue);
+}
+
+bool pushMPSCQueue(MPSCQueue *queue, const void *element)
+{
+	uint32_t position = (uint32_t)ZGAtomicLoad(&queue->tail);
+	while (true)
+	{
+		uint32_t slotIndex = position & (queue->capacity - 1);
+		int32_t difference = (int32_t)((uint32_t)ZGAtomicLoad(&queue->sequences[slotIndex]) - position);
+		if (difference == 0)
+		{
+			// Claim the slot; another producer may have beaten us to it
+			if (ZGAtomicCompareExchange(&queue->tail, (int32_t)position, (int32_t)(position + 1)))
+			{
+				memcpy(queue->elements + (size_t)slotIndex * queue->elementSize, element, queue->elementSize);
+				ZGAtomicStore(&queue->sequences[slotIndex], (int32_t)(position + 1));
+				return true;
+			}
+		}
+		else if (difference < 0)
+		{
+			// The consumer hasn't freed the slot from the previous lap yet
+			return false;
+		}
+		
+		position = (uint32_t)ZGAtomicLoad(&queue->tail);
+	}
+}
+
+bool popMPSCQueue(MPSCQueue *queue, void *element)
+{
+	uint32_t position = queue->head;
+	uint32_t slotIndex = position & (queue->capacity - 1);
+	
+	// A producer that claimed the slot but hasn't finished copying also reads as empty
+	if ((uint32_t)ZGAtomicLoad(&queue->sequences[slotIndex]) != position + 1)
+	{
+		return false;
+	}
+	
+	memcpy(element, queue->elements + (size_t)slotIndex * queue->elementSize, queue->elementSize);
+	
+	// Hand the slot to the producer that will claim it on the next lap
+	ZGAtomicStore(&queue->sequences[slotIndex], (int32_t)(position + queue->capacity));
+	queue->head = position + 1;
+	return true;
+}
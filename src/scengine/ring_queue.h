@@ -0,0 +1,53 @@
+/*
+ MIT License
+
+ Copyright (c) 2024 Mayur Pawashe
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Bounded ring queues that hand fixed-size elements, such as ZGKeyboardEvent or GamepadEvent, across threads without locking
+// Elements are copied in and out by value, so timestamps and other fields travel along with them
+// Neither queue waits: pushing to a full queue or popping from an empty one just returns false
+
+// One producer thread and one consumer thread
+typedef struct _SPSCQueue SPSCQueue;
+
+// Any number of producer threads and one consumer thread
+typedef struct _MPSCQueue MPSCQueue;
+
+// capacity is rounded up to a power of two; returns NULL if the queue can't be allocated
+SPSCQueue *createSPSCQueue(uint32_t capacity, size_t elementSize);
+void destroySPSCQueue(SPSCQueue *queue);
+
+bool pushSPSCQueue(SPSCQueue *queue, const void *element);
+bool popSPSCQueue(SPSCQueue *queue, void *element);
+
+// capacity is rounded up to a power of two; returns NULL if the queue can't be allocated
+MPSCQueue *createMPSCQueue(uint32_t capacity, size_t elementSize);
+void destroyMPSCQueue(MPSCQueue *queue);
+
+bool pushMPSCQueue(MPSCQueue *queue, const void *element);
+bool popMPSCQueue(MPSCQueue *queue, void *element);
@@ -0,0 +1,119 @@
+/*
+ MIT License
+
+ Copyright (c) 2024 Mayur Pawashe
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#pragma once
+
+// GLSL sources for the GL renderer, embedded so no shader files have to be read at launch
+// A #version line is prepended to each source when it is compiled
+// src/shadercheck.c renders the position and texture-position shaders offscreen to check them against shaders.metal
+
+static const char gPositionVertexShaderSource[] =
+	"in vec4 position;\n"
+	"\n"
+	"uniform mat4 modelViewProjectionMatrix;\n"
+	"\n"
+	"void main(void)\n"
+	"{\n"
+	"	gl_Position = modelViewProjectionMatrix * position;\n"
+	"}\n";
+
+static const char gPositionFragmentShaderSource[] =
+	"uniform vec4 color;\n"
+	"\n"
+	"out vec4 fragColor;\n"
+	"\n"
+	"void main(void)\n"
+	"{\n"
+	"	fragColor = color;\n"
+	"}\n";
+
+static const char gTexturePositionVertexShaderSource[] =
+	"in vec4 position;\n"
+	"in vec2 textureCoordIn;\n"
+	"\n"
+	"uniform mat4 modelViewProjectionMatrix;\n"
+	"\n"
+	"out vec2 textureCoord;\n"
+	"\n"
+	"void main(void)\n"
+	"{\n"
+	"	textureCoord = textureCoordIn;\n"
+	"	gl_Position = modelViewProjectionMatrix * position;\n"
+	"}\n";
+
+static const char gTexturePositionFragmentShaderSource[] =
+	"in vec2 textureCoord;\n"
+	"\n"
+	"uniform sampler2D textureSample;\n"
+	"uniform vec4 color;\n"
+	"\n"
+	"out vec4 fragColor;\n"
+	"\n"
+	"void main(void)\n"
+	"{\n"
+	"	fragColor = texture(textureSample, textureCoord) * color;\n"
+	"}\n";
+
+static const char gTexturePositionDistanceFieldFragmentShaderSource[] =
+	"in vec2 textureCoord;\n"
+	"\n"
+	"uniform sampler2D textureSample;\n"
+	"uniform vec4 color;\n"
+	"\n"
+	"out vec4 fragColor;\n"
+	"\n"
+	"void main(void)\n"
+	"{\n"
+	"	// The glyph's edge lies at 0.5; smooth over about one screen pixel at whatever scale we are drawn\n"
+	"	float distance = texture(textureSample, textureCoord).a;\n"
+	"	float smoothing = 0.7 * fwidth(distance);\n"
+	"	float coverage = smoothstep(0.5 - smoothing, 0.5 + smoothing, distance);\n"
+	"	\n"
+	"	fragColor = vec4(color.rgb, color.a * coverage);\n"
+	"}\n";
+
+static const char gPositionInstancedVertexShaderSource[] =
+	"in vec4 position;\n"
+	"in vec3 instanceTranslation;\n"
+	"in vec4 instanceColor;\n"
+	"\n"
+	"uniform mat4 modelViewProjectionMatrix;\n"
+	"\n"
+	"out vec4 instanceColorOut;\n"
+	"\n"
+	"void main(void)\n"
+	"{\n"
+	"	instanceColorOut = instanceColor;\n"
+	"	gl_Position = modelViewProjectionMatrix * (position + vec4(instanceTranslation, 0.0));\n"
+	"}\n";
+
+static const char gPositionInstancedFragmentShaderSource[] =
+	"in vec4 instanceColorOut;\n"
+	"\n"
+	"out vec4 fragColor;\n"
+	"\n"
+	"void main(void)\n"
+	"{\n"
+	"	fragColor = instanceColorOut;\n"
+	"}\n";
@@ -25,30 +25,307 @@
 #include "text.h"
 #include "font.h"
 #include "platforms.h"
+#include "thread.h"
+#include "job_system.h"
+#include "distance_field.h"
 #include <stdlib.h>
 #include <stdarg.h>
 #include <string.h>
 
+#define MAX_TEXT_LENGTH 256
+
+// Upper bound on cached strings; the byte budget normally evicts strings well before this is reached
+#define MAX_TEXT_RENDERING_COUNT 128
+// Must be a power of two
+#define TEXT_RENDERING_BUCKET_COUNT 256
+#define TEXT_RENDERING_NONE -1
+
 typedef struct
 {
 	TextureObject texture;
 	char *text;
+	uint32_t hash;
 	int width;
 	int height;
+	// Next rendering in the same hash bucket, or next free rendering when unused
+	int nextInBucket;
+	// Neighbors in the recently used list, which runs from most to least recently used
+	int previousUsed;
+	int nextUsed;
+	bool hasTexture;
+	bool rasterizationRequested;
+	bool pinned;
 } TextRendering;
 
-static int gTextRenderingCount = 0;
-static int gTextRenderingCacheMaxCount;
-static TextRendering *gTextRenderings;
+static TextRendering gTextRenderings[MAX_TEXT_RENDERING_COUNT];
+static int gTextRenderingBuckets[TEXT_RENDERING_BUCKET_COUNT];
+static int gFreeTextRenderingIndex;
+static int gMostRecentlyUsedTextRenderingIndex;
+static int gLeastRecentlyUsedTextRenderingIndex;
+
+static size_t gTextRenderingByteBudget;
+static TextCacheStatistics gTextCacheStatistics;
+
+// Strings are rasterized on a worker thread; the render thread only uploads the finished bitmaps
+#define MAX_TEXT_RASTERIZATION_COUNT 32
+
+typedef enum
+{
+	TEXT_RASTERIZATION_UNUSED = 0,
+	TEXT_RASTERIZATION_PENDING,
+	TEXT_RASTERIZATION_IN_PROGRESS,
+	TEXT_RASTERIZATION_FINISHED
+} TextRasterizationState;
+
+typedef struct
+{
+	char text[MAX_TEXT_LENGTH];
+	TextureData textureData;
+	TextRasterizationState state;
+} TextRasterization;
+
+// Guards gTextRasterizations and gTextRasterizationJobRunning
+static ZGMutex gTextRasterizationMutex;
+static TextRasterization gTextRasterizations[MAX_TEXT_RASTERIZATION_COUNT];
+static uint32_t gFinishedTextRasterizationCount;
+static bool gTextRasterizationJobRunning;
+
+// Where strings were last drawn, so a string that is still being rasterized can be
+// replaced by the string previously shown in its place
+#define MAX_TEXT_PLACEMENT_COUNT 16
+
+typedef struct
+{
+	mat4_t modelViewMatrix;
+	uint32_t hash;
+	int renderingIndex;
+} TextPlacement;
+
+static TextPlacement gTextPlacements[MAX_TEXT_PLACEMENT_COUNT];
+static int gTextPlacementCount;
+static int gNextTextPlacementIndex;
 
 static BufferArrayObject gFontVertexAndTextureBufferObject;
 static BufferObject gFontIndicesBufferObject;
 
-void initText(Renderer *renderer, int textRenderingCacheCount)
+// Printable ASCII glyphs are rasterized once into atlas pages so strings can be drawn without rasterizing them
+// Glyphs are stored as signed distance fields so the renderer can reconstruct sharp edges at any scale
+#define GLYPH_ATLAS_FIRST_CHARACTER 32
+#define GLYPH_ATLAS_LAST_CHARACTER 126
+#define GLYPH_ATLAS_CHARACTER_COUNT (GLYPH_ATLAS_LAST_CHARACTER - GLYPH_ATLAS_FIRST_CHARACTER + 1)
+#define GLYPH_ATLAS_PAGE_WIDTH 512
+#define GLYPH_ATLAS_PAGE_HEIGHT 512
+#define GLYPH_ATLAS_MAX_PAGE_COUNT 4
+// Spacing around each glyph so linear filtering doesn't sample neighboring glyphs
+#define GLYPH_ATLAS_PADDING 1
+// Each distance field texel covers this many pixels of the rasterized glyph in each dimension
+#define GLYPH_ATLAS_DISTANCE_FIELD_DOWNSAMPLE 4
+// Distance in texels from a glyph's edge at which its distance field saturates
+#define GLYPH_ATLAS_DISTANCE_FIELD_SPREAD 4
+
+typedef struct
+{
+	// Size of the rasterized glyph, which determines how far it advances
+	int width;
+	int height;
+	// Size and offset of the area covered by the glyph's distance field, in rasterized glyph pixels
+	int fieldWidth;
+	int fieldHeight;
+	int fieldOffset;
+	ZGFloat textureLeft;
+	ZGFloat textureTop;
+	ZGFloat textureRight;
+	ZGFloat textureBottom;
+	int pageIndex;
+	bool available;
+} AtlasGlyph;
+
+static TextureObject gGlyphAtlasPages[GLYPH_ATLAS_MAX_PAGE_COUNT];
+static int gGlyphAtlasPageCount;
+static AtlasGlyph gAtlasGlyphs[GLYPH_ATLAS_CHARACTER_COUNT];
+
+// Pages rasterized by prepareGlyphAtlas() that are waiting to be uploaded by initText()
+static uint8_t *gPreparedGlyphAtlasPages[GLYPH_ATLAS_MAX_PAGE_COUNT];
+static int gPreparedGlyphAtlasPageCount;
+static bool gGlyphAtlasPrepared;
+
+void prepareGlyphAtlas(void)
+{
+	if (gGlyphAtlasPrepared)
+	{
+		return;
+	}
+	gGlyphAtlasPrepared = true;
+	
+	size_t pageSize = GLYPH_ATLAS_PAGE_WIDTH * GLYPH_ATLAS_PAGE_HEIGHT * 4;
+	uint8_t *pagePixels = calloc(1, pageSize);
+	if (pagePixels == NULL)
+	{
+		fprintf(stderr, "Error: failed to allocate glyph atlas page\n");
+		return;
+	}
+	
+	int pageIndex = 0;
+	int cursorX = GLYPH_ATLAS_PADDING;
+	int cursorY = GLYPH_ATLAS_PADDING;
+	int rowHeight = 0;
+	
+	for (int character = GLYPH_ATLAS_FIRST_CHARACTER; character <= GLYPH_ATLAS_LAST_CHARACTER; character++)
+	{
+		const char glyphString[] = {(char)character, '\0'};
+		TextureData glyphData = createTextData(glyphString);
+		
+		int fieldWidth = distanceFieldSize(glyphData.width, GLYPH_ATLAS_DISTANCE_FIELD_DOWNSAMPLE, GLYPH_ATLAS_DISTANCE_FIELD_SPREAD);
+		int fieldHeight = distanceFieldSize(glyphData.height, GLYPH_ATLAS_DISTANCE_FIELD_DOWNSAMPLE, GLYPH_ATLAS_DISTANCE_FIELD_SPREAD);
+		
+		if (fieldWidth + 2 * GLYPH_ATLAS_PADDING > GLYPH_ATLAS_PAGE_WIDTH || fieldHeight + 2 * GLYPH_ATLAS_PADDING > GLYPH_ATLAS_PAGE_HEIGHT)
+		{
+			fprintf(stderr, "Error: glyph '%c' is too large for the glyph atlas\n", character);
+			freeTextureData(glyphData);
+			continue;
+		}
+		
+		uint8_t *distanceField = malloc((size_t)fieldWidth * (size_t)fieldHeight);
+		if (distanceField == NULL || !createDistanceField(glyphData.pixelData, glyphData.width, glyphData.height, GLYPH_ATLAS_DISTANCE_FIELD_DOWNSAMPLE, GLYPH_ATLAS_DISTANCE_FIELD_SPREAD, distanceField))
+		{
+			fprintf(stderr, "Error: failed to create distance field for glyph '%c'\n", character);
+			free(distanceField);
+			freeTextureData(glyphData);
+			continue;
+		}
+		
+		// Move on to the next row, and then to the next page, when the glyph doesn't fit
+		if (cursorX + fieldWidth + GLYPH_ATLAS_PADDING > GLYPH_ATLAS_PAGE_WIDTH)
+		{
+			cursorX = GLYPH_ATLAS_PADDING;
+			cursorY += rowHeight + GLYPH_ATLAS_PADDING;
+			rowHeight = 0;
+		}
+		
+		if (cursorY + fieldHeight + GLYPH_ATLAS_PADDING > GLYPH_ATLAS_PAGE_HEIGHT)
+		{
+			if (pageIndex + 1 >= GLYPH_ATLAS_MAX_PAGE_COUNT)
+			{
+				fprintf(stderr, "Error: ran out of glyph atlas pages at glyph '%c'\n", character);
+				free(distanceField);
+				freeTextureData(glyphData);
+				break;
+			}
+			
+			uint8_t *nextPagePixels = calloc(1, pageSize);
+			if (nextPagePixels == NULL)
+			{
+				fprintf(stderr, "Error: failed to allocate glyph atlas page\n");
+				free(distanceField);
+				freeTextureData(glyphData);
+				break;
+			}
+			
+			gPreparedGlyphAtlasPages[pageIndex] = pagePixels;
+			pagePixels = nextPagePixels;
+			
+			pageIndex++;
+			cursorX = GLYPH_ATLAS_PADDING;
+			cursorY = GLYPH_ATLAS_PADDING;
+			rowHeight = 0;
+		}
+		
+		// Distances go in the alpha channel of white texels
+		for (int fieldY = 0; fieldY < fieldHeight; fieldY++)
+		{
+			for (int fieldX = 0; fieldX < fieldWidth; fieldX++)
+			{
+				uint8_t *pixel = pagePixels + ((size_t)(cursorY + fieldY) * GLYPH_ATLAS_PAGE_WIDTH + (size_t)(cursorX + fieldX)) * 4;
+				pixel[0] = 0xFF;
+				pixel[1] = 0xFF;
+				pixel[2] = 0xFF;
+				pixel[3] = distanceField[fieldY * fieldWidth + fieldX];
+			}
+		}
+		
+		AtlasGlyph *glyph = &gAtlasGlyphs[character - GLYPH_ATLAS_FIRST_CHARACTER];
+		glyph->width = glyphData.width;
+		glyph->height = glyphData.height;
+		glyph->fieldWidth = fieldWidth * GLYPH_ATLAS_DISTANCE_FIELD_DOWNSAMPLE;
+		glyph->fieldHeight = fieldHeight * GLYPH_ATLAS_DISTANCE_FIELD_DOWNSAMPLE;
+		glyph->fieldOffset = GLYPH_ATLAS_DISTANCE_FIELD_SPREAD * GLYPH_ATLAS_DISTANCE_FIELD_DOWNSAMPLE;
+		glyph->textureLeft = (ZGFloat)cursorX / GLYPH_ATLAS_PAGE_WIDTH;
+		glyph->textureTop = (ZGFloat)cursorY / GLYPH_ATLAS_PAGE_HEIGHT;
+		glyph->textureRight = (ZGFloat)(cursorX + fieldWidth) / GLYPH_ATLAS_PAGE_WIDTH;
+		glyph->textureBottom = (ZGFloat)(cursorY + fieldHeight) / GLYPH_ATLAS_PAGE_HEIGHT;
+		glyph->pageIndex = pageIndex;
+		glyph->available = true;
+		
+		cursorX += fieldWidth + GLYPH_ATLAS_PADDING;
+		if (fieldHeight > rowHeight)
+		{
+			rowHeight = fieldHeight;
+		}
+		
+		free(distanceField);
+		freeTextureData(glyphData);
+	}
+	
+	gPreparedGlyphAtlasPages[pageIndex] = pagePixels;
+	gPreparedGlyphAtlasPageCount = pageIndex + 1;
+}
+
+static void uploadGlyphAtlas(Renderer *renderer)
+{
+	for (int pageIndex = 0; pageIndex < gPreparedGlyphAtlasPageCount; pageIndex++)
+	{
+		gGlyphAtlasPages[pageIndex] = textureFromPixelData(renderer, gPreparedGlyphAtlasPages[pageIndex], GLYPH_ATLAS_PAGE_WIDTH, GLYPH_ATLAS_PAGE_HEIGHT, PIXEL_FORMAT_RGBA32);
+	}
+	gGlyphAtlasPageCount = gPreparedGlyphAtlasPageCount;
+}
+
+static void freePreparedGlyphAtlas(void)
+{
+	for (int pageIndex = 0; pageIndex < gPreparedGlyphAtlasPageCount; pageIndex++)
+	{
+		free(gPreparedGlyphAtlasPages[pageIndex]);
+		gPreparedGlyphAtlasPages[pageIndex] = NULL;
+	}
+	gPreparedGlyphAtlasPageCount = 0;
+}
+
+static bool glyphAtlasContainsString(const char *string)
 {
-	gTextRenderings = calloc(textRenderingCacheCount, sizeof(*gTextRenderings));
-    gTextRenderingCacheMaxCount = textRenderingCacheCount;
-    
+	if (gGlyphAtlasPageCount == 0)
+	{
+		return false;
+	}
+	
+	for (size_t characterIndex = 0; characterIndex < MAX_TEXT_LENGTH - 1 && string[characterIndex] != '\0'; characterIndex++)
+	{
+		unsigned char character = (unsigned char)string[characterIndex];
+		if (character < GLYPH_ATLAS_FIRST_CHARACTER || character > GLYPH_ATLAS_LAST_CHARACTER || !gAtlasGlyphs[character - GLYPH_ATLAS_FIRST_CHARACTER].available)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void initText(Renderer *renderer, size_t textRenderingCacheByteBudget)
+{
+	gTextRenderingByteBudget = textRenderingCacheByteBudget;
+	
+	for (int bucketIndex = 0; bucketIndex < TEXT_RENDERING_BUCKET_COUNT; bucketIndex++)
+	{
+		gTextRenderingBuckets[bucketIndex] = TEXT_RENDERING_NONE;
+	}
+	
+	for (int renderingIndex = 0; renderingIndex < MAX_TEXT_RENDERING_COUNT; renderingIndex++)
+	{
+		gTextRenderings[renderingIndex].nextInBucket = (renderingIndex + 1 < MAX_TEXT_RENDERING_COUNT) ? renderingIndex + 1 : TEXT_RENDERING_NONE;
+	}
+	gFreeTextRenderingIndex = 0;
+	gMostRecentlyUsedTextRenderingIndex = TEXT_RENDERING_NONE;
+	gLeastRecentlyUsedTextRenderingIndex = TEXT_RENDERING_NONE;
+	
+	gTextRasterizationMutex = ZGCreateMutex();
+	
 	const ZGFloat verticesAndTextureCoordinates[] =
 	{
 		// vertices
@@ -67,6 +344,14 @@ void initText(Renderer *renderer, int textRenderingCacheCount)
 	gFontVertexAndTextureBufferObject = createVertexAndTextureCoordinateArrayObject(renderer, verticesAndTextureCoordinates, 16 * sizeof(*verticesAndTextureCoordinates), 8 * sizeof(*verticesAndTextureCoordinates));
 	
 	gFontIndicesBufferObject = rectangleIndexBufferObject(renderer);
+	
+	// Renderers that can't batch texture quads draw each string from its own texture instead
+	if (canDrawTextureQuads(renderer))
+	{
+		prepareGlyphAtlas();
+		uploadGlyphAtlas(renderer);
+	}
+	freePreparedGlyphAtlas();
 }
 
 #if SUPPORT_DEPRECATED_DRAW_STRING_APIS
@@ -148,57 +433,451 @@ void drawStringf(Renderer *renderer, mat4_t modelViewMatrix, color4_t color, ZGF
 }
 #endif
 
-#define MAX_TEXT_LENGTH 256
-int cacheString(Renderer *renderer, const char *string)
+static size_t textLength(const char *string)
+{
+	size_t length = strlen(string);
+	return (length < MAX_TEXT_LENGTH - 1) ? length : MAX_TEXT_LENGTH - 1;
+}
+
+// FNV-1a
+static uint32_t textHash(const char *string, size_t length)
+{
+	uint32_t hash = 2166136261u;
+	for (size_t characterIndex = 0; characterIndex < length; characterIndex++)
+	{
+		hash ^= (uint8_t)string[characterIndex];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+static size_t textRenderingByteCount(const TextRendering *rendering)
+{
+	return rendering->hasTexture ? (size_t)rendering->width * (size_t)rendering->height * 4 : 0;
+}
+
+static int findTextRendering(const char *string, size_t length, uint32_t hash)
+{
+	for (int renderingIndex = gTextRenderingBuckets[hash & (TEXT_RENDERING_BUCKET_COUNT - 1)]; renderingIndex != TEXT_RENDERING_NONE; renderingIndex = gTextRenderings[renderingIndex].nextInBucket)
+	{
+		const TextRendering *rendering = &gTextRenderings[renderingIndex];
+		if (rendering->hash == hash && strncmp(rendering->text, string, length) == 0 && rendering->text[length] == '\0')
+		{
+			return renderingIndex;
+		}
+	}
+	return TEXT_RENDERING_NONE;
+}
+
+static void unlinkUsedTextRendering(int renderingIndex)
+{
+	TextRendering *rendering = &gTextRenderings[renderingIndex];
+	
+	if (rendering->previousUsed != TEXT_RENDERING_NONE)
+	{
+		gTextRenderings[rendering->previousUsed].nextUsed = rendering->nextUsed;
+	}
+	else
+	{
+		gMostRecentlyUsedTextRenderingIndex = rendering->nextUsed;
+	}
+	
+	if (rendering->nextUsed != TEXT_RENDERING_NONE)
+	{
+		gTextRenderings[rendering->nextUsed].previousUsed = rendering->previousUsed;
+	}
+	else
+	{
+		gLeastRecentlyUsedTextRenderingIndex = rendering->previousUsed;
+	}
+}
+
+static void linkMostRecentlyUsedTextRendering(int renderingIndex)
+{
+	TextRendering *rendering = &gTextRenderings[renderingIndex];
+	
+	rendering->previousUsed = TEXT_RENDERING_NONE;
+	rendering->nextUsed = gMostRecentlyUsedTextRenderingIndex;
+	
+	if (gMostRecentlyUsedTextRenderingIndex != TEXT_RENDERING_NONE)
+	{
+		gTextRenderings[gMostRecentlyUsedTextRenderingIndex].previousUsed = renderingIndex;
+	}
+	else
+	{
+		gLeastRecentlyUsedTextRenderingIndex = renderingIndex;
+	}
+	gMostRecentlyUsedTextRenderingIndex = renderingIndex;
+}
+
+static void removeTextRendering(Renderer *renderer, int renderingIndex)
+{
+	TextRendering *rendering = &gTextRenderings[renderingIndex];
+	
+	int *bucketLink = &gTextRenderingBuckets[rendering->hash & (TEXT_RENDERING_BUCKET_COUNT - 1)];
+	while (*bucketLink != renderingIndex)
+	{
+		bucketLink = &gTextRenderings[*bucketLink].nextInBucket;
+	}
+	*bucketLink = rendering->nextInBucket;
+	
+	unlinkUsedTextRendering(renderingIndex);
+	
+	if (rendering->hasTexture)
+	{
+		gTextCacheStatistics.byteCount -= textRenderingByteCount(rendering);
+		deleteTexture(renderer, rendering->texture);
+	}
+	free(rendering->text);
+	
+	memset(rendering, 0, sizeof(*rendering));
+	rendering->nextInBucket = gFreeTextRenderingIndex;
+	gFreeTextRenderingIndex = renderingIndex;
+	
+	gTextCacheStatistics.entryCount--;
+}
+
+// Evicts the least recently used string that isn't pinned, other than keepIndex
+// If texturesOnly is true, strings that are still waiting to be rasterized are skipped
+// Returns false if there is nothing left to evict
+static bool evictLeastRecentlyUsedTextRendering(Renderer *renderer, int keepIndex, bool texturesOnly)
+{
+	for (int renderingIndex = gLeastRecentlyUsedTextRenderingIndex; renderingIndex != TEXT_RENDERING_NONE; renderingIndex = gTextRenderings[renderingIndex].previousUsed)
+	{
+		const TextRendering *rendering = &gTextRenderings[renderingIndex];
+		if (renderingIndex != keepIndex && !rendering->pinned && (rendering->hasTexture || !texturesOnly))
+		{
+			removeTextRendering(renderer, renderingIndex);
+			gTextCacheStatistics.evictionCount++;
+			return true;
+		}
+	}
+	return false;
+}
+
+static int insertTextRendering(Renderer *renderer, const char *string, size_t length, uint32_t hash)
 {
-	int cachedIndex = -1;
-	int renderingCount = gTextRenderingCount < gTextRenderingCacheMaxCount ? gTextRenderingCount : gTextRenderingCacheMaxCount;
-	for (int i = 0; i < renderingCount; i++)
+	if (gFreeTextRenderingIndex == TEXT_RENDERING_NONE && !evictLeastRecentlyUsedTextRendering(renderer, TEXT_RENDERING_NONE, false))
+	{
+		fprintf(stderr, "Error: text cache is full of pinned strings\n");
+		return TEXT_RENDERING_NONE;
+	}
+	
+	char *text = calloc(length + 1, 1);
+	if (text == NULL)
 	{
-		if (strncmp(string, gTextRenderings[i].text, 256) == 0)
+		return TEXT_RENDERING_NONE;
+	}
+	memcpy(text, string, length);
+	
+	int renderingIndex = gFreeTextRenderingIndex;
+	TextRendering *rendering = &gTextRenderings[renderingIndex];
+	gFreeTextRenderingIndex = rendering->nextInBucket;
+	
+	rendering->text = text;
+	rendering->hash = hash;
+	rendering->hasTexture = false;
+	rendering->rasterizationRequested = false;
+	rendering->pinned = false;
+	
+	int *bucket = &gTextRenderingBuckets[hash & (TEXT_RENDERING_BUCKET_COUNT - 1)];
+	rendering->nextInBucket = *bucket;
+	*bucket = renderingIndex;
+	
+	linkMostRecentlyUsedTextRendering(renderingIndex);
+	
+	gTextCacheStatistics.entryCount++;
+	
+	return renderingIndex;
+}
+
+static void rasterizeTextJob(void *context)
+{
+	ZGLockMutex(gTextRasterizationMutex);
+	while (true)
+	{
+		TextRasterization *rasterization = NULL;
+		for (int rasterizationIndex = 0; rasterizationIndex < MAX_TEXT_RASTERIZATION_COUNT; rasterizationIndex++)
+		{
+			if (gTextRasterizations[rasterizationIndex].state == TEXT_RASTERIZATION_PENDING)
+			{
+				rasterization = &gTextRasterizations[rasterizationIndex];
+				break;
+			}
+		}
+		
+		// Finish once there's no work left; the next request submits a new job
+		if (rasterization == NULL)
 		{
-			cachedIndex = i;
+			gTextRasterizationJobRunning = false;
 			break;
 		}
+		
+		// The text is left alone by the render thread while rasterization is in progress
+		rasterization->state = TEXT_RASTERIZATION_IN_PROGRESS;
+		ZGUnlockMutex(gTextRasterizationMutex);
+		
+		TextureData textureData = createTextData(rasterization->text);
+		
+		ZGLockMutex(gTextRasterizationMutex);
+		rasterization->textureData = textureData;
+		rasterization->state = TEXT_RASTERIZATION_FINISHED;
+		gFinishedTextRasterizationCount++;
 	}
+	ZGUnlockMutex(gTextRasterizationMutex);
+}
+
+static bool requestTextRasterization(const char *text)
+{
+	bool startJob = false;
+	bool requested = false;
 	
-	if (cachedIndex == -1)
+	ZGLockMutex(gTextRasterizationMutex);
+	for (int rasterizationIndex = 0; rasterizationIndex < MAX_TEXT_RASTERIZATION_COUNT; rasterizationIndex++)
 	{
-		char *newText = calloc(MAX_TEXT_LENGTH, 1);
-		if (newText != NULL)
+		TextRasterization *rasterization = &gTextRasterizations[rasterizationIndex];
+		if (rasterization->state == TEXT_RASTERIZATION_UNUSED)
 		{
-			// If we run past gTextRenderingCacheMaxCount, re-cycle through our old text renderings
-			// and replace those
-			int insertionIndex = gTextRenderingCount % gTextRenderingCacheMaxCount;
+			strncpy(rasterization->text, text, MAX_TEXT_LENGTH - 1);
+			rasterization->text[MAX_TEXT_LENGTH - 1] = '\0';
+			rasterization->state = TEXT_RASTERIZATION_PENDING;
+			requested = true;
 			
-			if (gTextRenderings[insertionIndex].text != NULL)
+			if (!gTextRasterizationJobRunning)
 			{
-				free(gTextRenderings[insertionIndex].text);
-				deleteTexture(renderer, gTextRenderings[insertionIndex].texture);
+				gTextRasterizationJobRunning = true;
+				startJob = true;
 			}
+			break;
+		}
+	}
+	ZGUnlockMutex(gTextRasterizationMutex);
+	
+	if (startJob)
+	{
+		submitJob(rasterizeTextJob, NULL, NULL);
+	}
+	
+	return requested;
+}
+
+static void setTextRenderingTexture(Renderer *renderer, int renderingIndex, TextureData textureData)
+{
+	TextRendering *rendering = &gTextRenderings[renderingIndex];
+	
+	// Make room for the new texture; pinned strings may still push us past our budget
+	size_t byteCount = (size_t)textureData.width * (size_t)textureData.height * 4;
+	while (gTextCacheStatistics.byteCount + byteCount > gTextRenderingByteBudget)
+	{
+		if (!evictLeastRecentlyUsedTextRendering(renderer, renderingIndex, true))
+		{
+			break;
+		}
+	}
+	
+	rendering->width = textureData.width;
+	rendering->height = textureData.height;
+	rendering->texture = textureFromPixelData(renderer, textureData.pixelData, textureData.width, textureData.height, textureData.pixelFormat);
+	rendering->hasTexture = true;
+	rendering->rasterizationRequested = false;
+	
+	gTextCacheStatistics.byteCount += byteCount;
+}
+
+// Uploads strings the worker thread has finished rasterizing
+static void finishTextRasterizations(Renderer *renderer)
+{
+	int finishedRenderingIndices[MAX_TEXT_RASTERIZATION_COUNT];
+	TextureData finishedTextureDatas[MAX_TEXT_RASTERIZATION_COUNT];
+	int finishedCount = 0;
+	
+	ZGLockMutex(gTextRasterizationMutex);
+	if (gFinishedTextRasterizationCount > 0)
+	{
+		for (int rasterizationIndex = 0; rasterizationIndex < MAX_TEXT_RASTERIZATION_COUNT; rasterizationIndex++)
+		{
+			TextRasterization *rasterization = &gTextRasterizations[rasterizationIndex];
+			if (rasterization->state == TEXT_RASTERIZATION_FINISHED)
+			{
+				// The string may have been evicted while it was being rasterized
+				size_t length = textLength(rasterization->text);
+				finishedRenderingIndices[finishedCount] = findTextRendering(rasterization->text, length, textHash(rasterization->text, length));
+				finishedTextureDatas[finishedCount] = rasterization->textureData;
+				finishedCount++;
+				
+				rasterization->state = TEXT_RASTERIZATION_UNUSED;
+			}
+		}
+		gFinishedTextRasterizationCount = 0;
+	}
+	ZGUnlockMutex(gTextRasterizationMutex);
+	
+	for (int finishedIndex = 0; finishedIndex < finishedCount; finishedIndex++)
+	{
+		int renderingIndex = finishedRenderingIndices[finishedIndex];
+		if (renderingIndex != TEXT_RENDERING_NONE && !gTextRenderings[renderingIndex].hasTexture)
+		{
+			setTextRenderingTexture(renderer, renderingIndex, finishedTextureDatas[finishedIndex]);
+		}
+		freeTextureData(finishedTextureDatas[finishedIndex]);
+	}
+}
+
+bool isRasterizingText(void)
+{
+	ZGLockMutex(gTextRasterizationMutex);
+	bool rasterizing = gTextRasterizationJobRunning;
+	ZGUnlockMutex(gTextRasterizationMutex);
+	
+	return rasterizing;
+}
+
+// Returns the index of the string's rendering, or -1 if it isn't rasterized yet
+int cacheString(Renderer *renderer, const char *string)
+{
+	finishTextRasterizations(renderer);
+	
+	size_t length = textLength(string);
+	uint32_t hash = textHash(string, length);
+	
+	int renderingIndex = findTextRendering(string, length, hash);
+	if (renderingIndex != TEXT_RENDERING_NONE)
+	{
+		unlinkUsedTextRendering(renderingIndex);
+		linkMostRecentlyUsedTextRendering(renderingIndex);
+	}
+	else
+	{
+		renderingIndex = insertTextRendering(renderer, string, length, hash);
+		if (renderingIndex == TEXT_RENDERING_NONE)
+		{
+			return -1;
+		}
+	}
+	
+	TextRendering *rendering = &gTextRenderings[renderingIndex];
+	if (rendering->hasTexture)
+	{
+		gTextCacheStatistics.hitCount++;
+		return renderingIndex;
+	}
+	
+	// If every request slot is taken, try again the next time the string is drawn
+	if (!rendering->rasterizationRequested && requestTextRasterization(rendering->text))
+	{
+		rendering->rasterizationRequested = true;
+		gTextCacheStatistics.missCount++;
+	}
+	
+	return -1;
+}
+
+// Returns the index of the rendering to draw for a string at modelViewMatrix, or -1 if there's nothing to draw yet
+static int placeString(Renderer *renderer, mat4_t modelViewMatrix, const char *string)
+{
+	int renderingIndex = cacheString(renderer, string);
+	
+	TextPlacement *placement = NULL;
+	for (int placementIndex = 0; placementIndex < gTextPlacementCount; placementIndex++)
+	{
+		if (memcmp(&gTextPlacements[placementIndex].modelViewMatrix, &modelViewMatrix, sizeof(modelViewMatrix)) == 0)
+		{
+			placement = &gTextPlacements[placementIndex];
+			break;
+		}
+	}
+	
+	if (renderingIndex != -1)
+	{
+		if (placement == NULL)
+		{
+			placement = &gTextPlacements[gNextTextPlacementIndex];
+			placement->modelViewMatrix = modelViewMatrix;
 			
-			gTextRenderings[insertionIndex].text = newText;
-			strncpy(gTextRenderings[insertionIndex].text, string, MAX_TEXT_LENGTH - 1);
-			
-			TextureData textData = createTextData(newText);
-			gTextRenderings[insertionIndex].width = textData.width;
-			gTextRenderings[insertionIndex].height = textData.height;
-			gTextRenderings[insertionIndex].texture = textureFromPixelData(renderer, textData.pixelData, gTextRenderings[insertionIndex].width, gTextRenderings[insertionIndex].height, textData.pixelFormat);
-			
-			freeTextureData(textData);
-			
-			cachedIndex = insertionIndex;
-			gTextRenderingCount++;
+			gNextTextPlacementIndex = (gNextTextPlacementIndex + 1) % MAX_TEXT_PLACEMENT_COUNT;
+			if (gTextPlacementCount < MAX_TEXT_PLACEMENT_COUNT)
+			{
+				gTextPlacementCount++;
+			}
+		}
+		
+		placement->renderingIndex = renderingIndex;
+		placement->hash = gTextRenderings[renderingIndex].hash;
+		
+		return renderingIndex;
+	}
+	
+	// Keep showing the previous string until the new one is ready, provided it hasn't been evicted
+	if (placement != NULL)
+	{
+		const TextRendering *previousRendering = &gTextRenderings[placement->renderingIndex];
+		if (previousRendering->hasTexture && previousRendering->hash == placement->hash)
+		{
+			return placement->renderingIndex;
 		}
 	}
 	
-	return cachedIndex;
+	return -1;
+}
+
+void prewarmStrings(Renderer *renderer, const char **strings, size_t stringCount)
+{
+	for (size_t stringIndex = 0; stringIndex < stringCount; stringIndex++)
+	{
+		if (!glyphAtlasContainsString(strings[stringIndex]))
+		{
+			cacheString(renderer, strings[stringIndex]);
+		}
+	}
+}
+
+void pinString(Renderer *renderer, const char *string)
+{
+	size_t length = textLength(string);
+	uint32_t hash = textHash(string, length);
+	
+	int renderingIndex = findTextRendering(string, length, hash);
+	if (renderingIndex == TEXT_RENDERING_NONE)
+	{
+		// The string is only rasterized once it is first drawn
+		renderingIndex = insertTextRendering(renderer, string, length, hash);
+		if (renderingIndex == TEXT_RENDERING_NONE)
+		{
+			return;
+		}
+	}
+	
+	gTextRenderings[renderingIndex].pinned = true;
+}
+
+void unpinString(Renderer *renderer, const char *string)
+{
+	size_t length = textLength(string);
+	int renderingIndex = findTextRendering(string, length, textHash(string, length));
+	if (renderingIndex == TEXT_RENDERING_NONE)
+	{
+		return;
+	}
+	
+	TextRendering *rendering = &gTextRenderings[renderingIndex];
+	rendering->pinned = false;
+	
+	// Drop strings that were pinned but never drawn
+	if (!rendering->hasTexture)
+	{
+		removeTextRendering(renderer, renderingIndex);
+	}
+}
+
+TextCacheStatistics getTextCacheStatistics(void)
+{
+	return gTextCacheStatistics;
 }
 
 #if SUPPORT_DEPRECATED_DRAW_STRING_APIS
 void drawString(Renderer *renderer, mat4_t modelViewMatrix, color4_t color, ZGFloat width, ZGFloat height, const char *string)
 {
-	int index = cacheString(renderer, string);
+	int index = placeString(renderer, modelViewMatrix, string);
 	if (index == -1) return;
 	
 	mat4_t scaleMatrix = m4_scaling((vec3_t){width, height, 0.0f});
@@ -208,9 +887,68 @@ void drawString(Renderer *renderer, mat4_t modelViewMatrix, color4_t color, ZGFl
 }
 #endif
 
+// Draws the string as one batch of glyph quads per atlas page
+// Returns false without drawing anything if a character isn't in the atlas
+static bool drawStringFromGlyphAtlas(Renderer *renderer, mat4_t modelViewMatrix, color4_t color, ZGFloat scale, const char *string, bool leftAligned)
+{
+	if (!glyphAtlasContainsString(string))
+	{
+		return false;
+	}
+	
+	size_t length = textLength(string);
+	
+	int stringWidth = 0;
+	for (size_t characterIndex = 0; characterIndex < length; characterIndex++)
+	{
+		stringWidth += gAtlasGlyphs[(unsigned char)string[characterIndex] - GLYPH_ATLAS_FIRST_CHARACTER].width;
+	}
+	
+	// Cover the same area as a whole string texture drawn over our -1 to 1 rectangle
+	ZGFloat startX = leftAligned ? 0.0f : -stringWidth * scale;
+	
+	RendererTextureVertex vertices[(MAX_TEXT_LENGTH - 1) * 4];
+	for (int pageIndex = 0; pageIndex < gGlyphAtlasPageCount; pageIndex++)
+	{
+		uint32_t quadCount = 0;
+		ZGFloat x = startX;
+		for (size_t characterIndex = 0; characterIndex < length; characterIndex++)
+		{
+			const AtlasGlyph *glyph = &gAtlasGlyphs[(unsigned char)string[characterIndex] - GLYPH_ATLAS_FIRST_CHARACTER];
+			ZGFloat glyphWidth = 2.0f * glyph->width * scale;
+			
+			if (glyph->pageIndex == pageIndex)
+			{
+				// The distance field extends past the glyph's bitmap on every side
+				ZGFloat left = x - 2.0f * glyph->fieldOffset * scale;
+				ZGFloat right = left + 2.0f * glyph->fieldWidth * scale;
+				ZGFloat top = (glyph->height + 2.0f * glyph->fieldOffset) * scale;
+				ZGFloat bottom = top - 2.0f * glyph->fieldHeight * scale;
+				
+				RendererTextureVertex *quad = &vertices[quadCount * 4];
+				
+				quad[0] = (RendererTextureVertex){{left, bottom, 0.0f, 1.0f}, {glyph->textureLeft, glyph->textureBottom}};
+				quad[1] = (RendererTextureVertex){{left, top, 0.0f, 1.0f}, {glyph->textureLeft, glyph->textureTop}};
+				quad[2] = (RendererTextureVertex){{right, top, 0.0f, 1.0f}, {glyph->textureRight, glyph->textureTop}};
+				quad[3] = (RendererTextureVertex){{right, bottom, 0.0f, 1.0f}, {glyph->textureRight, glyph->textureBottom}};
+				
+				quadCount++;
+			}
+			
+			x += glyphWidth;
+		}
+		
+		drawTextureQuads(renderer, modelViewMatrix, gGlyphAtlasPages[pageIndex], vertices, quadCount, color, RENDERER_OPTION_BLENDING_ONE_MINUS_ALPHA | RENDERER_OPTION_DISTANCE_FIELD);
+	}
+	
+	return true;
+}
+
 void drawStringScaled(Renderer *renderer, mat4_t modelViewMatrix, color4_t color, ZGFloat scale, const char *string)
 {
-	int index = cacheString(renderer, string);
+	if (drawStringFromGlyphAtlas(renderer, modelViewMatrix, color, scale, string, false)) return;
+	
+	int index = placeString(renderer, modelViewMatrix, string);
 	if (index == -1) return;
 	
 	int width = gTextRenderings[index].width;
@@ -224,7 +962,9 @@ void drawStringScaled(Renderer *renderer, mat4_t modelViewMatrix, color4_t color
 
 void drawStringLeftAligned(Renderer *renderer, mat4_t modelViewMatrix, color4_t color, ZGFloat scale, const char *string)
 {
-	int index = cacheString(renderer, string);
+	if (drawStringFromGlyphAtlas(renderer, modelViewMatrix, color, scale, string, true)) return;
+	
+	int index = placeString(renderer, modelViewMatrix, string);
 	if (index == -1) return;
 	
 	int width = gTextRenderings[index].width;
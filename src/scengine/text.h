@@ -27,10 +27,44 @@
 #include "math_3d.h"
 #include "renderer.h"
 
+#include <stddef.h>
+#include <stdint.h>
+
 #define SUPPORT_DEPRECATED_DRAW_STRING_APIS 0
 
+typedef struct
+{
+	uint32_t hitCount;
+	uint32_t missCount;
+	uint32_t evictionCount;
+	uint32_t entryCount;
+	// Bytes of string textures currently cached
+	size_t byteCount;
+} TextCacheStatistics;
+
+// Rasterizes printable ASCII glyphs into atlas pages ahead of initText() so it can overlap renderer creation
+// Requires Font subsystem to be initialized first, and may be called from a worker thread before initText()
+void prepareGlyphAtlas(void);
+
 // Requires Font subsystem to be initialized first
-void initText(Renderer *renderer, int textRenderingCacheCount);
+// If the renderer can draw texture quads, the glyph atlas is uploaded here, rasterizing it first if prepareGlyphAtlas() wasn't called
+// Strings that don't go through the glyph atlas are cached as textures
+// The least recently used strings are evicted to keep the cached textures under textRenderingCacheByteBudget
+void initText(Renderer *renderer, size_t textRenderingCacheByteBudget);
+
+// Pinned strings are never evicted from the text cache
+void pinString(Renderer *renderer, const char *string);
+void unpinString(Renderer *renderer, const char *string);
+
+// Starts rasterizing strings that are not drawn from the glyph atlas ahead of their first use
+// Strings are rasterized on a worker thread, and until a string is ready the string previously drawn in its place is shown
+void prewarmStrings(Renderer *renderer, const char **strings, size_t stringCount);
+
+// Returns true while strings are being rasterized in the background
+// Finished strings are uploaded and shown the next time they are drawn
+bool isRasterizingText(void);
+
+TextCacheStatistics getTextCacheStatistics(void);
 
 #if SUPPORT_DEPRECATED_DRAW_STRING_APIS
 // Deprecated
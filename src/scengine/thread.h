@@ -22,19 +22,57 @@
  SOFTWARE.
  */
 
+#pragma once
+
 #include <stdint.h>
+#include <stdbool.h>
 
 typedef void* ZGThread;
 typedef int (*ZGThreadFunction)(void *data);
 
 typedef void* ZGMutex;
+typedef void* ZGCondition;
+typedef void* ZGDelayTimer;
 
 ZGThread ZGCreateThread(ZGThreadFunction function, const char *name, void *data);
 void ZGWaitThread(ZGThread thread);
 
-// ZGDestroyMutex() is not provided because we don't need to destroy them in our game
 ZGMutex ZGCreateMutex(void);
+void ZGDestroyMutex(ZGMutex mutex);
 void ZGLockMutex(ZGMutex mutex);
 void ZGUnlockMutex(ZGMutex mutex);
 
+ZGCondition ZGCreateCondition(void);
+void ZGDestroyCondition(ZGCondition condition);
+// The mutex must be locked; it is unlocked while waiting and locked again before returning
+// Wakeups may be spurious so always re-check what is being waited on
+void ZGWaitCondition(ZGCondition condition, ZGMutex mutex);
+void ZGSignalCondition(ZGCondition condition);
+void ZGBroadcastCondition(ZGCondition condition);
+
 void ZGDelay(uint32_t delayMilliseconds);
+
+// A timer reused across ZGDelayNanoseconds() calls; NULL where the platform doesn't need one or can't create one
+ZGDelayTimer ZGCreateDelayTimer(void);
+void ZGDestroyDelayTimer(ZGDelayTimer timer);
+// Sleeps as precisely as the platform's timers allow, which is well under a millisecond
+// A NULL timer may fall back to sleeping in whole milliseconds, rounded up
+void ZGDelayNanoseconds(ZGDelayTimer timer, uint64_t delayNanoseconds);
+
+// Number of logical processors available, at least 1
+uint32_t ZGProcessorCount(void);
+
+// Only access the value through the functions below, which are sequentially consistent
+typedef struct
+{
+	volatile int32_t value;
+} ZGAtomicInt;
+
+int32_t ZGAtomicLoad(ZGAtomicInt *atomic);
+void ZGAtomicStore(ZGAtomicInt *atomic, int32_t value);
+// Returns the value that was replaced
+int32_t ZGAtomicExchange(ZGAtomicInt *atomic, int32_t value);
+// Returns the value before adding
+int32_t ZGAtomicFetchAdd(ZGAtomicInt *atomic, int32_t value);
+// Stores desired only if the current value is expected; returns whether it was stored
+bool ZGAtomicCompareExchange(ZGAtomicInt *atomic, int32_t expected, int32_t desired);
@@ -32,6 +32,7 @@
 #include <time.h>
 #include <errno.h>
 #include <pthread.h>
+#include <unistd.h>
 
 typedef struct
 {
@@ -114,6 +115,16 @@ ZGMutex ZGCreateMutex(void)
 	return mutex;
 }
 
+void ZGDestroyMutex(ZGMutex mutex)
+{
+	int result = pthread_mutex_destroy(mutex);
+	if (result != 0)
+	{
+		fprintf(stderr, "Failed to destroy mutex: %d - %s\n", result, strerror(result));
+	}
+	free(mutex);
+}
+
 void ZGLockMutex(ZGMutex mutex)
 {
 	int result = pthread_mutex_lock(mutex);
@@ -126,11 +137,69 @@ void ZGUnlockMutex(ZGMutex mutex)
 	assert(result == 0);
 }
 
+ZGCondition ZGCreateCondition(void)
+{
+	pthread_cond_t *condition = calloc(1, sizeof(*condition));
+	assert(condition != NULL);
+	
+	int result = pthread_cond_init(condition, NULL);
+	if (result != 0)
+	{
+		fprintf(stderr, "Failed to create condition: %d - %s\n", result, strerror(result));
+		ZGQuit();
+	}
+	
+	return condition;
+}
+
+void ZGDestroyCondition(ZGCondition condition)
+{
+	int result = pthread_cond_destroy(condition);
+	if (result != 0)
+	{
+		fprintf(stderr, "Failed to destroy condition: %d - %s\n", result, strerror(result));
+	}
+	free(condition);
+}
+
+void ZGWaitCondition(ZGCondition condition, ZGMutex mutex)
+{
+	int result = pthread_cond_wait(condition, mutex);
+	assert(result == 0);
+}
+
+void ZGSignalCondition(ZGCondition condition)
+{
+	int result = pthread_cond_signal(condition);
+	assert(result == 0);
+}
+
+void ZGBroadcastCondition(ZGCondition condition)
+{
+	int result = pthread_cond_broadcast(condition);
+	assert(result == 0);
+}
+
 void ZGDelay(uint32_t delayMilliseconds)
+{
+	ZGDelayNanoseconds(NULL, (uint64_t)delayMilliseconds * 1000000);
+}
+
+ZGDelayTimer ZGCreateDelayTimer(void)
+{
+	// nanosleep() is already precise
+	return NULL;
+}
+
+void ZGDestroyDelayTimer(ZGDelayTimer timer)
+{
+}
+
+void ZGDelayNanoseconds(ZGDelayTimer timer, uint64_t delayNanoseconds)
 {
 	struct timespec delaySpec;
-	delaySpec.tv_sec = delayMilliseconds / 1000;
-	delaySpec.tv_nsec = (delayMilliseconds % 1000) * 1000000;
+	delaySpec.tv_sec = (time_t)(delayNanoseconds / 1000000000);
+	delaySpec.tv_nsec = (long)(delayNanoseconds % 1000000000);
 	int result;
 	do
 	{
@@ -140,3 +209,34 @@ void ZGDelay(uint32_t delayMilliseconds)
 	}
 	while (result != 0 && errno == EINTR);
 }
+
+uint32_t ZGProcessorCount(void)
+{
+	long processorCount = sysconf(_SC_NPROCESSORS_ONLN);
+	return (processorCount > 0) ? (uint32_t)processorCount : 1;
+}
+
+int32_t ZGAtomicLoad(ZGAtomicInt *atomic)
+{
+	return __atomic_load_n(&atomic->value, __ATOMIC_SEQ_CST);
+}
+
+void ZGAtomicStore(ZGAtomicInt *atomic, int32_t value)
+{
+	__atomic_store_n(&atomic->value, value, __ATOMIC_SEQ_CST);
+}
+
+int32_t ZGAtomicExchange(ZGAtomicInt *atomic, int32_t value)
+{
+	return __atomic_exchange_n(&atomic->value, value, __ATOMIC_SEQ_CST);
+}
+
+int32_t ZGAtomicFetchAdd(ZGAtomicInt *atomic, int32_t value)
+{
+	return __atomic_fetch_add(&atomic->value, value, __ATOMIC_SEQ_CST);
+}
+
+bool ZGAtomicCompareExchange(ZGAtomicInt *atomic, int32_t expected, int32_t desired)
+{
+	return __atomic_compare_exchange_n(&atomic->value, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
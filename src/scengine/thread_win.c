@@ -60,6 +60,12 @@ ZGMutex ZGCreateMutex(void)
 	return mutex;
 }
 
+void ZGDestroyMutex(ZGMutex mutex)
+{
+	DeleteCriticalSection(mutex);
+	free(mutex);
+}
+
 void ZGLockMutex(ZGMutex mutex)
 {
 	EnterCriticalSection(mutex);
@@ -70,7 +76,112 @@ void ZGUnlockMutex(ZGMutex mutex)
 	LeaveCriticalSection(mutex);
 }
 
+ZGCondition ZGCreateCondition(void)
+{
+	CONDITION_VARIABLE *condition = calloc(1, sizeof(*condition));
+	InitializeConditionVariable(condition);
+	return condition;
+}
+
+void ZGDestroyCondition(ZGCondition condition)
+{
+	// Condition variables don't need to be deleted on Windows
+	free(condition);
+}
+
+void ZGWaitCondition(ZGCondition condition, ZGMutex mutex)
+{
+	if (!SleepConditionVariableCS(condition, mutex, INFINITE))
+	{
+		fprintf(stderr, "Error: Failed to SleepConditionVariableCS(): %d\n", GetLastError());
+	}
+}
+
+void ZGSignalCondition(ZGCondition condition)
+{
+	WakeConditionVariable(condition);
+}
+
+void ZGBroadcastCondition(ZGCondition condition)
+{
+	WakeAllConditionVariable(condition);
+}
+
 void ZGDelay(uint32_t delayMilliseconds)
 {
 	Sleep(delayMilliseconds);
 }
+
+// Only available since Windows 10 version 1803, and missing from older SDK headers
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+ZGDelayTimer ZGCreateDelayTimer(void)
+{
+	// Sleep() rounds up to the scheduler's ~15.6 ms period, but a high resolution timer wakes on time
+	HANDLE timer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+	if (timer == NULL)
+	{
+		fprintf(stderr, "Error: Failed to create high resolution timer: %d\n", GetLastError());
+	}
+	return timer;
+}
+
+void ZGDestroyDelayTimer(ZGDelayTimer timer)
+{
+	if (timer != NULL && !CloseHandle(timer))
+	{
+		fprintf(stderr, "Error: Failed to CloseHandle()\n");
+	}
+}
+
+void ZGDelayNanoseconds(ZGDelayTimer timer, uint64_t delayNanoseconds)
+{
+	if (timer != NULL)
+	{
+		// Negative due times are relative, in 100 nanosecond units
+		LARGE_INTEGER dueTime;
+		dueTime.QuadPart = -(LONGLONG)(delayNanoseconds / 100);
+		if (SetWaitableTimer(timer, &dueTime, 0, NULL, NULL, FALSE))
+		{
+			WaitForSingleObject(timer, INFINITE);
+			return;
+		}
+	}
+	
+	// Round up so short waits still sleep instead of only yielding with Sleep(0)
+	Sleep((DWORD)((delayNanoseconds + 999999) / 1000000));
+}
+
+uint32_t ZGProcessorCount(void)
+{
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+	return (systemInfo.dwNumberOfProcessors > 0) ? (uint32_t)systemInfo.dwNumberOfProcessors : 1;
+}
+
+int32_t ZGAtomicLoad(ZGAtomicInt *atomic)
+{
+	return InterlockedOr((volatile LONG *)&atomic->value, 0);
+}
+
+void ZGAtomicStore(ZGAtomicInt *atomic, int32_t value)
+{
+	InterlockedExchange((volatile LONG *)&atomic->value, value);
+}
+
+int32_t ZGAtomicExchange(ZGAtomicInt *atomic, int32_t value)
+{
+	return InterlockedExchange((volatile LONG *)&atomic->value, value);
+}
+
+int32_t ZGAtomicFetchAdd(ZGAtomicInt *atomic, int32_t value)
+{
+	return InterlockedExchangeAdd((volatile LONG *)&atomic->value, value);
+}
+
+bool ZGAtomicCompareExchange(ZGAtomicInt *atomic, int32_t expected, int32_t desired)
+{
+	return InterlockedCompareExchange((volatile LONG *)&atomic->value, desired, expected) == expected;
+}
@@ -33,5 +33,5 @@ uint32_t ZGGetTicks(void)
 
 uint64_t ZGGetNanoTicks(void)
 {
-	return (uint64_t)(ZGGetTicks() * 1000000.0);
+	return SDL_GetTicksNS();
 }
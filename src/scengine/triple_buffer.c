@@ -0,0 +1,104 @@
+/*
+ MIT License
+
+ Copyright (c) 2024 Mayur Pawashe
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#include "triple_buffer.h"
+#include "thread.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// The shared index also records whether it was published since the consumer last took it
+#define TRIPLE_BUFFER_INDEX_MASK 0x3
+#define TRIPLE_BUFFER_PUBLISHED_FLAG 0x4
+
+struct _TripleBuffer
+{
+	uint8_t *buffers[3];
+	// The buffer being handed between threads; writeIndex and readIndex are only touched by their own thread
+	ZGAtomicInt sharedIndex;
+	int32_t writeIndex;
+	int32_t readIndex;
+};
+
+TripleBuffer *createTripleBuffer(size_t bufferSize)
+{
+	TripleBuffer *tripleBuffer = calloc(1, sizeof(*tripleBuffer));
+	if (tripleBuffer == NULL)
+	{
+		return NULL;
+	}
+	
+	for (int bufferIndex = 0; bufferIndex < 3; bufferIndex++)
+	{
+		tripleBuffer->buffers[bufferIndex] = calloc(1, bufferSize);
+		if (tripleBuffer->buffers[bufferIndex] == NULL)
+		{
+			destroyTripleBuffer(tripleBuffer);
+			return NULL;
+		}
+	}
+	
+	tripleBuffer->writeIndex = 0;
+	ZGAtomicStore(&tripleBuffer->sharedIndex, 1);
+	tripleBuffer->readIndex = 2;
+	
+	return tripleBuffer;
+}
+
+void destroyTripleBuffer(TripleBuffer *tripleBuffer)
+{
+	for (int bufferIndex = 0; bufferIndex < 3; bufferIndex++)
+	{
+		free(tripleBuffer->buffers[bufferIndex]);
+	}
+	free(tripleBuffer);
+}
+
+void *tripleBufferWriteBuffer(TripleBuffer *tripleBuffer)
+{
+	return tripleBuffer->buffers[tripleBuffer->writeIndex];
+}
+
+void publishTripleBuffer(TripleBuffer *tripleBuffer)
+{
+	int32_t previousSharedIndex = ZGAtomicExchange(&tripleBuffer->sharedIndex, tripleBuffer->writeIndex | TRIPLE_BUFFER_PUBLISHED_FLAG);
+	tripleBuffer->writeIndex = previousSharedIndex & TRIPLE_BUFFER_INDEX_MASK;
+}
+
+const void *readTripleBuffer(TripleBuffer *tripleBuffer, bool *updated)
+{
+	bool published = (ZGAtomicLoad(&tripleBuffer->sharedIndex) & TRIPLE_BUFFER_PUBLISHED_FLAG) != 0;
+	if (published)
+	{
+		int32_t previousSharedIndex = ZGAtomicExchange(&tripleBuffer->sharedIndex, tripleBuffer->readIndex);
+		tripleBuffer->readIndex = previousSharedIndex & TRIPLE_BUFFER_INDEX_MASK;
+	}
+	
+	if (updated != NULL)
+	{
+		*updated = published;
+	}
+	
+	return tripleBuffer->buffers[tripleBuffer->readIndex];
+}
@@ -0,0 +1,45 @@
+/*
+ MIT License
+
+ Copyright (c) 2024 Mayur Pawashe
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+
+// Hands buffers from one producer thread to one consumer thread without locking or waiting
+// The producer always has a buffer to write to and the consumer always reads the most recently published one
+typedef struct _TripleBuffer TripleBuffer;
+
+// Returns NULL if the buffers can't be allocated; buffers start out zeroed
+TripleBuffer *createTripleBuffer(size_t bufferSize);
+
+void destroyTripleBuffer(TripleBuffer *tripleBuffer);
+
+// Producer side: fill in the write buffer and then publish it, which hands over a different buffer to write to next
+void *tripleBufferWriteBuffer(TripleBuffer *tripleBuffer);
+void publishTripleBuffer(TripleBuffer *tripleBuffer);
+
+// Consumer side: returns the most recently published buffer, which stays valid until the next call
+// updated is set to whether a newer buffer was published since the last call
+const void *readTripleBuffer(TripleBuffer *tripleBuffer, bool *updated);
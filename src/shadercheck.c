@@ -0,0 +1,522 @@
+/*
+ MIT License
+
+ Copyright (c) 2024 Mayur Pawashe
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+// Renders with the GLSL embedded in shaders_gl.h through an offscreen EGL context and checks the pixels
+// against what shaders.metal and the HLSL shaders compute: color for position, color * texel for texture-position
+// Passing the Data/Shaders directory of a shipped build also renders with those files and requires identical pixels
+// Build from src/ with "make shadercheck" (needs EGL and OpenGL 4.1, a software driver such as Mesa's is enough), or with:
+//   cc -O2 -Iscengine shadercheck.c -lEGL -lGL -lm -o shadercheck
+// Usage:
+//   shadercheck [--shipped-shaders DIR]
+
+#define GL_GLEXT_PROTOTYPES 1
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GL/gl.h>
+#include <GL/glext.h>
+
+#include "shaders_gl.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The version and attribute locations renderer_gl.c uses
+#define GLSL_VERSION 410
+#define VERTEX_ATTRIBUTE 0
+#define TEXTURE_ATTRIBUTE 1
+
+#define TARGET_SIZE 64
+// Pixels this close to a projected edge may be covered or not depending on the rasterizer
+#define EDGE_MARGIN 1.0f
+// Drivers may round color * texel to either neighboring 8-bit value
+#define CHANNEL_TOLERANCE 1
+
+typedef struct
+{
+    GLuint program;
+    GLint modelViewProjectionMatrixLocation;
+    GLint colorLocation;
+    GLint textureSampleLocation;
+} CheckProgram;
+
+static char *readFile(const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Error: failed to open %s\n", path);
+        return NULL;
+    }
+    
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    
+    char *contents = (size >= 0) ? malloc((size_t)size + 1) : NULL;
+    if (contents != NULL && fread(contents, 1, (size_t)size, file) == (size_t)size)
+    {
+        contents[size] = '\0';
+    }
+    else
+    {
+        fprintf(stderr, "Error: failed to read %s\n", path);
+        free(contents);
+        contents = NULL;
+    }
+    fclose(file);
+    return contents;
+}
+
+static GLuint compileShader(GLenum type, const char *source, const char *name)
+{
+    char versionLine[32];
+    snprintf(versionLine, sizeof(versionLine), "#version %u\n", GLSL_VERSION);
+    
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 2, (const GLchar *[]){versionLine, source}, (GLint []){(GLint)strlen(versionLine), (GLint)strlen(source)});
+    glCompileShader(shader);
+    
+    GLint status = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status == 0)
+    {
+        GLchar log[1024] = {0};
+        glGetShaderInfoLog(shader, sizeof(log) - 1, NULL, log);
+        fprintf(stderr, "Error: failed to compile %s:\n%s\n", name, log);
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+// Links the same way compileAndLinkShader() in renderer_gl.c does
+static bool createCheckProgram(CheckProgram *checkProgram, const char *vertexSource, const char *fragmentSource, bool textured, const char *name)
+{
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource, name);
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource, name);
+    if (vertexShader == 0 || fragmentShader == 0)
+    {
+        return false;
+    }
+    
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glBindAttribLocation(program, VERTEX_ATTRIBUTE, "position");
+    if (textured)
+    {
+        glBindAttribLocation(program, TEXTURE_ATTRIBUTE, "textureCoordIn");
+    }
+    glBindFragDataLocation(program, 0, "fragColor");
+    glLinkProgram(program);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+    
+    GLint status = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (status == 0)
+    {
+        fprintf(stderr, "Error: failed to link %s\n", name);
+        return false;
+    }
+    
+    checkProgram->program = program;
+    checkProgram->modelViewProjectionMatrixLocation = glGetUniformLocation(program, "modelViewProjectionMatrix");
+    checkProgram->colorLocation = glGetUniformLocation(program, "color");
+    checkProgram->textureSampleLocation = textured ? glGetUniformLocation(program, "textureSample") : -1;
+    if (checkProgram->modelViewProjectionMatrixLocation == -1 || checkProgram->colorLocation == -1 || (textured && checkProgram->textureSampleLocation == -1))
+    {
+        fprintf(stderr, "Error: %s is missing a uniform the renderer sets\n", name);
+        return false;
+    }
+    return true;
+}
+
+static bool createContext(void)
+{
+    EGLDisplay display = EGL_NO_DISPLAY;
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay != NULL)
+    {
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    }
+    if (display == EGL_NO_DISPLAY)
+    {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+    
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, NULL, NULL) || !eglBindAPI(EGL_OPENGL_API))
+    {
+        fprintf(stderr, "Error: failed to initialize EGL\n");
+        return false;
+    }
+    
+    const EGLint configAttributes[] = {EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0)
+    {
+        fprintf(stderr, "Error: no EGL config supports OpenGL\n");
+        return false;
+    }
+    
+    const EGLint contextAttributes[] = {EGL_CONTEXT_MAJOR_VERSION, 4, EGL_CONTEXT_MINOR_VERSION, 1, EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT, EGL_NONE};
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+    if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+    {
+        fprintf(stderr, "Error: failed to create an OpenGL 4.1 core context\n");
+        return false;
+    }
+    
+    return true;
+}
+
+// Column-major, as the renderer uploads it
+static void multiplyMatrices(const float *left, const float *right, float *result)
+{
+    for (int column = 0; column < 4; column++)
+    {
+        for (int row = 0; row < 4; row++)
+        {
+            float sum = 0.0f;
+            for (int index = 0; index < 4; index++)
+            {
+                sum += left[index * 4 + row] * right[column * 4 + index];
+            }
+            result[column * 4 + row] = sum;
+        }
+    }
+}
+
+static void transformPoint(const float *matrix, const float *point, float *result)
+{
+    for (int row = 0; row < 4; row++)
+    {
+        result[row] = matrix[row] * point[0] + matrix[4 + row] * point[1] + matrix[8 + row] * point[2] + matrix[12 + row] * point[3];
+    }
+}
+
+// A rotated, translated quad seen through a perspective projection, so a transposed or misapplied matrix lands elsewhere
+static void positionCheckMatrix(float *modelViewProjectionMatrix)
+{
+    const float nearPlane = 1.0f;
+    const float farPlane = 10.0f;
+    const float projection[16] =
+    {
+        1.5f, 0.0f, 0.0f, 0.0f,
+        0.0f, 1.5f, 0.0f, 0.0f,
+        0.0f, 0.0f, (farPlane + nearPlane) / (nearPlane - farPlane), -1.0f,
+        0.0f, 0.0f, 2.0f * farPlane * nearPlane / (nearPlane - farPlane), 0.0f
+    };
+    // Rotated 0.5 radians about z and 0.3 about x, then pushed away from the camera and off center
+    const float cosZ = 0.87758f, sinZ = 0.47943f, cosX = 0.95534f, sinX = 0.29552f;
+    const float modelView[16] =
+    {
+        cosZ, sinZ * cosX, sinZ * sinX, 0.0f,
+        -sinZ, cosZ * cosX, cosZ * sinX, 0.0f,
+        0.0f, -sinX, cosX, 0.0f,
+        0.4f, -0.2f, -4.0f, 1.0f
+    };
+    multiplyMatrices(projection, modelView, modelViewProjectionMatrix);
+}
+
+static const float gQuadPositions[] =
+{
+    -1.0f, -1.0f, 0.0f, 1.0f,
+    1.0f, -1.0f, 0.0f, 1.0f,
+    -1.0f, 1.0f, 0.0f, 1.0f,
+    1.0f, 1.0f, 0.0f, 1.0f
+};
+
+static const float gQuadTextureCoordinates[] =
+{
+    0.0f, 0.0f,
+    1.0f, 0.0f,
+    0.0f, 1.0f,
+    1.0f, 1.0f
+};
+
+static void drawQuad(const CheckProgram *checkProgram, const float *modelViewProjectionMatrix, const float *color, GLuint texture, uint8_t *pixels)
+{
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    
+    glUseProgram(checkProgram->program);
+    glUniformMatrix4fv(checkProgram->modelViewProjectionMatrixLocation, 1, GL_FALSE, modelViewProjectionMatrix);
+    glUniform4fv(checkProgram->colorLocation, 1, color);
+    if (checkProgram->textureSampleLocation != -1)
+    {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glUniform1i(checkProgram->textureSampleLocation, 0);
+    }
+    
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    glReadPixels(0, 0, TARGET_SIZE, TARGET_SIZE, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+}
+
+static uint8_t unitToByte(float value)
+{
+    return (uint8_t)(value * 255.0f + 0.5f);
+}
+
+static bool channelsMatch(const uint8_t *pixel, const uint8_t *expected)
+{
+    for (int channel = 0; channel < 4; channel++)
+    {
+        if (abs((int)pixel[channel] - (int)expected[channel]) > CHANNEL_TOLERANCE)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Signed distance in pixels from (x, y) to the inside of the counterclockwise edge a -> b
+static float edgeDistance(const float *a, const float *b, float x, float y)
+{
+    float edgeX = b[0] - a[0];
+    float edgeY = b[1] - a[1];
+    float length = sqrtf(edgeX * edgeX + edgeY * edgeY);
+    return (edgeX * (y - a[1]) - edgeY * (x - a[0])) / length;
+}
+
+// Position shader: every pixel well inside the projected quad is the uniform color, every pixel well outside is untouched
+static uint32_t checkPositionPixels(const uint8_t *pixels, const float *modelViewProjectionMatrix, const float *color, uint32_t *checkedCount)
+{
+    // Window coordinates of the quad's corners, in counterclockwise order
+    const int cornerOrder[] = {0, 1, 3, 2};
+    float corners[4][2];
+    for (int cornerIndex = 0; cornerIndex < 4; cornerIndex++)
+    {
+        float clip[4];
+        transformPoint(modelViewProjectionMatrix, &gQuadPositions[cornerOrder[cornerIndex] * 4], clip);
+        corners[cornerIndex][0] = (clip[0] / clip[3] * 0.5f + 0.5f) * TARGET_SIZE;
+        corners[cornerIndex][1] = (clip[1] / clip[3] * 0.5f + 0.5f) * TARGET_SIZE;
+    }
+    
+    const uint8_t inside[4] = {unitToByte(color[0]), unitToByte(color[1]), unitToByte(color[2]), unitToByte(color[3])};
+    const uint8_t outside[4] = {0, 0, 0, 0};
+    
+    uint32_t mismatchCount = 0;
+    for (int y = 0; y < TARGET_SIZE; y++)
+    {
+        for (int x = 0; x < TARGET_SIZE; x++)
+        {
+            float minimumDistance = INFINITY;
+            for (int cornerIndex = 0; cornerIndex < 4; cornerIndex++)
+            {
+                float distance = edgeDistance(corners[cornerIndex], corners[(cornerIndex + 1) % 4], x + 0.5f, y + 0.5f);
+                minimumDistance = fminf(minimumDistance, distance);
+            }
+            
+            if (fabsf(minimumDistance) < EDGE_MARGIN)
+            {
+                continue;
+            }
+            
+            (*checkedCount)++;
+            if (!channelsMatch(&pixels[(y * TARGET_SIZE + x) * 4], (minimumDistance > 0.0f) ? inside : outside))
+            {
+                mismatchCount++;
+            }
+        }
+    }
+    return mismatchCount;
+}
+
+// Texture-position shader: the quad covers the target texel for texel, so each pixel is its texel times the color
+static uint32_t checkTexturePositionPixels(const uint8_t *pixels, const uint8_t *texels, const float *color, uint32_t *checkedCount)
+{
+    uint32_t mismatchCount = 0;
+    for (uint32_t pixelIndex = 0; pixelIndex < TARGET_SIZE * TARGET_SIZE; pixelIndex++)
+    {
+        uint8_t expected[4];
+        for (int channel = 0; channel < 4; channel++)
+        {
+            expected[channel] = unitToByte(texels[pixelIndex * 4 + channel] / 255.0f * color[channel]);
+        }
+        
+        (*checkedCount)++;
+        if (!channelsMatch(&pixels[pixelIndex * 4], expected))
+        {
+            mismatchCount++;
+        }
+    }
+    return mismatchCount;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *shippedShadersDirectory = NULL;
+    for (int argumentIndex = 1; argumentIndex < argc; argumentIndex++)
+    {
+        const char *argument = argv[argumentIndex];
+        if (strcmp(argument, "--shipped-shaders") == 0 && argumentIndex + 1 < argc)
+        {
+            shippedShadersDirectory = argv[++argumentIndex];
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [--shipped-shaders DIR]\n", argv[0]);
+            return 1;
+        }
+    }
+    
+    if (!createContext())
+    {
+        return 1;
+    }
+    
+    GLuint framebuffer = 0;
+    GLuint renderbuffer = 0;
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glGenRenderbuffers(1, &renderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, TARGET_SIZE, TARGET_SIZE);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        fprintf(stderr, "Error: offscreen framebuffer is incomplete\n");
+        return 1;
+    }
+    glViewport(0, 0, TARGET_SIZE, TARGET_SIZE);
+    
+    // Laid out like createVertexAndTextureCoordinateArrayObject_gl(): all positions, then all texture coordinates
+    GLuint vertexArray = 0;
+    GLuint vertexBuffer = 0;
+    glGenVertexArrays(1, &vertexArray);
+    glBindVertexArray(vertexArray);
+    glGenBuffers(1, &vertexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(gQuadPositions) + sizeof(gQuadTextureCoordinates), NULL, GL_STATIC_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(gQuadPositions), gQuadPositions);
+    glBufferSubData(GL_ARRAY_BUFFER, sizeof(gQuadPositions), sizeof(gQuadTextureCoordinates), gQuadTextureCoordinates);
+    glEnableVertexAttribArray(VERTEX_ATTRIBUTE);
+    glVertexAttribPointer(VERTEX_ATTRIBUTE, 4, GL_FLOAT, GL_FALSE, 0, (GLvoid *)0);
+    glEnableVertexAttribArray(TEXTURE_ATTRIBUTE);
+    glVertexAttribPointer(TEXTURE_ATTRIBUTE, 2, GL_FLOAT, GL_FALSE, 0, (GLvoid *)sizeof(gQuadPositions));
+    
+    // Sampled with the filtering textureFromPixelData_gl() sets up; texel centers line up with pixel centers
+    static uint8_t texels[TARGET_SIZE * TARGET_SIZE * 4];
+    for (uint32_t texelIndex = 0; texelIndex < TARGET_SIZE * TARGET_SIZE; texelIndex++)
+    {
+        uint32_t x = texelIndex % TARGET_SIZE;
+        uint32_t y = texelIndex / TARGET_SIZE;
+        texels[texelIndex * 4 + 0] = (uint8_t)(x * 4);
+        texels[texelIndex * 4 + 1] = (uint8_t)(y * 4);
+        texels[texelIndex * 4 + 2] = (uint8_t)((x ^ y) * 4);
+        texels[texelIndex * 4 + 3] = (uint8_t)(255 - ((x + y) % 64) * 2);
+    }
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, TARGET_SIZE, TARGET_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, texels);
+    
+    CheckProgram positionProgram;
+    CheckProgram texturePositionProgram;
+    if (!createCheckProgram(&positionProgram, gPositionVertexShaderSource, gPositionFragmentShaderSource, false, "embedded position shader") || !createCheckProgram(&texturePositionProgram, gTexturePositionVertexShaderSource, gTexturePositionFragmentShaderSource, true, "embedded texture-position shader"))
+    {
+        return 1;
+    }
+    
+    float positionMatrix[16];
+    positionCheckMatrix(positionMatrix);
+    const float identityMatrix[16] = {1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+    const float positionColor[4] = {0.2f, 0.6f, 0.9f, 0.8f};
+    const float textureColor[4] = {1.0f, 0.5f, 0.25f, 0.75f};
+    
+    static uint8_t positionPixels[TARGET_SIZE * TARGET_SIZE * 4];
+    static uint8_t texturePositionPixels[TARGET_SIZE * TARGET_SIZE * 4];
+    drawQuad(&positionProgram, positionMatrix, positionColor, 0, positionPixels);
+    drawQuad(&texturePositionProgram, identityMatrix, textureColor, texture, texturePositionPixels);
+    
+    uint32_t positionCheckedCount = 0;
+    uint32_t positionMismatchCount = checkPositionPixels(positionPixels, positionMatrix, positionColor, &positionCheckedCount);
+    uint32_t texturePositionCheckedCount = 0;
+    uint32_t texturePositionMismatchCount = checkTexturePositionPixels(texturePositionPixels, texels, textureColor, &texturePositionCheckedCount);
+    
+    printf("renderer: %s\n", (const char *)glGetString(GL_RENDERER));
+    printf("position: %u pixels checked, %u mismatched\n", positionCheckedCount, positionMismatchCount);
+    printf("texture-position: %u pixels checked, %u mismatched\n", texturePositionCheckedCount, texturePositionMismatchCount);
+    
+    bool passed = (positionMismatchCount == 0 && texturePositionMismatchCount == 0);
+    
+    if (shippedShadersDirectory != NULL)
+    {
+        const char *shaderNames[] = {"position.vsh", "position.fsh", "texture-position.vsh", "texture-position.fsh"};
+        char *shippedSources[4] = {NULL};
+        for (int shaderIndex = 0; shaderIndex < 4; shaderIndex++)
+        {
+            char path[1024];
+            snprintf(path, sizeof(path), "%s/%s", shippedShadersDirectory, shaderNames[shaderIndex]);
+            shippedSources[shaderIndex] = readFile(path);
+            if (shippedSources[shaderIndex] == NULL)
+            {
+                return 1;
+            }
+        }
+        
+        CheckProgram shippedPositionProgram;
+        CheckProgram shippedTexturePositionProgram;
+        if (!createCheckProgram(&shippedPositionProgram, shippedSources[0], shippedSources[1], false, "shipped position shader") || !createCheckProgram(&shippedTexturePositionProgram, shippedSources[2], shippedSources[3], true, "shipped texture-position shader"))
+        {
+            return 1;
+        }
+        
+        static uint8_t shippedPixels[TARGET_SIZE * TARGET_SIZE * 4];
+        drawQuad(&shippedPositionProgram, positionMatrix, positionColor, 0, shippedPixels);
+        bool positionIdentical = (memcmp(shippedPixels, positionPixels, sizeof(shippedPixels)) == 0);
+        drawQuad(&shippedTexturePositionProgram, identityMatrix, textureColor, texture, shippedPixels);
+        bool texturePositionIdentical = (memcmp(shippedPixels, texturePositionPixels, sizeof(shippedPixels)) == 0);
+        
+        printf("shipped position: %s\n", positionIdentical ? "identical" : "DIFFERENT");
+        printf("shipped texture-position: %s\n", texturePositionIdentical ? "identical" : "DIFFERENT");
+        
+        passed = passed && positionIdentical && texturePositionIdentical;
+        
+        for (int shaderIndex = 0; shaderIndex < 4; shaderIndex++)
+        {
+            free(shippedSources[shaderIndex]);
+        }
+    }
+    
+    GLenum error = glGetError();
+    if (error != GL_NO_ERROR)
+    {
+        fprintf(stderr, "Error: GL error 0x%x\n", error);
+        passed = false;
+    }
+    
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,671 @@
+/*
+ MIT License
+
+ Copyright (c) 2024 Mayur Pawashe
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#include "simulation.h"
+#include "cube_collision.h"
+#include "mt_random.h"
+
+#include <stdlib.h>
+
+#define PLAYER_INITIAL_SPEED 4.0f
+#define PLAYER_SPEED_CAP 20.0f
+#define PLAYER_SPEED_INCREASE 0.2f
+#define CUBE_PLAYER_DIST_AWAY 100.0f
+#define CUBE_PLAYER_WARN_MAX_FACTOR 8
+// A cube warns when the player's path would hit it within this window of time from now
+// These were two and a hundred and one steps at the default tick rate, and are in seconds so every tick rate warns alike
+#define CUBE_PLAYER_WARN_NEAREST_FUTURE_TIME (2 * SIMULATION_TICK_INTERVAL)
+#define CUBE_PLAYER_WARN_FARTHEST_FUTURE_TIME (101 * SIMULATION_TICK_INTERVAL)
+
+#define CUBE_FLAG_WARNING_PATH_HITS 0x4
+
+#define RANDOM_BATCH_COUNT MT_LEN
+
+// Once fewer cubes than this are left alive, the next field is requested ahead of time
+#define NEXT_FIELD_REQUEST_THRESHOLD 256
+
+#define MAX_CUBE_COUNT_PER_LEVEL 5
+
+// Cube indices only ever increase and are wrapped into the field's storage, which endless mode uses as a ring buffer
+#define CUBE_INDEX_MASK (MAX_CUBE_COUNT - 1)
+
+// In endless mode the world is shifted back towards the origin whenever the player travels this far, to keep float precision
+#define ORIGIN_REBASE_DISTANCE 2048.0f
+
+typedef struct
+{
+    // Cached depths at which the player's current path enters and exits collision range of a cube
+    // Only valid while warningGeneration matches the simulation's warningGeneration
+    ZGFloat enterDepth;
+    ZGFloat exitDepth;
+    uint32_t warningGeneration;
+} CubeWarningPath;
+
+// Cubes are stored as separate arrays so the collision kernel can load positions directly into SIMD lanes
+typedef struct
+{
+    ZGFloat *xs;
+    ZGFloat *ys;
+    ZGFloat *zs;
+    uint8_t *flags;
+    uint8_t *colorIndices;
+    CubeWarningPath *warningPaths;
+    uint8_t *collisionResults;
+    
+    // Number of cubes generated so far and the depth the next row of cubes goes at
+    uint32_t count;
+    ZGFloat nextRowDepth;
+} CubeField;
+
+struct _Simulation
+{
+    SimulationMode mode;
+    
+    vec3_t playerPosition;
+    vec3_t previousPlayerPosition;
+    ZGFloat playerSpeed;
+    uint32_t score;
+    
+    CubeField cubes;
+    
+    // The field swapped in once every cube in the current one has been passed, which only happens in classic mode
+    // While a field generator has been requested and not yet waited on, nextCubes and the random state belong to it
+    CubeField nextCubes;
+    SimulationFieldGenerator fieldGenerator;
+    bool requestedNextField;
+    
+    // Cubes are generated in decreasing depth, so they die in order and only a window of them can be near the player
+    // cubeWindowStart is the first alive cube and cubeWindowEnd is one past the last cube within view distance
+    uint32_t cubeWindowStart;
+    uint32_t cubeWindowEnd;
+    
+    // Bumped whenever the player's path changes, invalidating every cube's cached warning depths
+    uint32_t warningGeneration;
+    ZGFloat lastDeltaX;
+    
+    uint32_t originRebaseCount;
+    
+    ZGFloat playerCubeDiagonalSumDistance;
+    
+    // Random numbers are drawn from the state in batches and handed out from randomBatch
+    MTState randomState;
+    uint32_t randomBatch[RANDOM_BATCH_COUNT];
+    uint32_t randomBatchIndex;
+    
+    bool playerLost;
+};
+
+static void createCubeField(CubeField *cubes)
+{
+    cubes->xs = calloc(MAX_CUBE_COUNT, sizeof(*cubes->xs));
+    cubes->ys = calloc(MAX_CUBE_COUNT, sizeof(*cubes->ys));
+    cubes->zs = calloc(MAX_CUBE_COUNT, sizeof(*cubes->zs));
+    cubes->flags = calloc(MAX_CUBE_COUNT, sizeof(*cubes->flags));
+    cubes->colorIndices = calloc(MAX_CUBE_COUNT, sizeof(*cubes->colorIndices));
+    cubes->warningPaths = calloc(MAX_CUBE_COUNT, sizeof(*cubes->warningPaths));
+    cubes->collisionResults = calloc(MAX_CUBE_COUNT, sizeof(*cubes->collisionResults));
+}
+
+static void destroyCubeField(CubeField *cubes)
+{
+    free(cubes->xs);
+    free(cubes->ys);
+    free(cubes->zs);
+    free(cubes->flags);
+    free(cubes->colorIndices);
+    free(cubes->warningPaths);
+    free(cubes->collisionResults);
+}
+
+static uint32_t nextRandom(Simulation *simulation)
+{
+    if (simulation->randomBatchIndex >= RANDOM_BATCH_COUNT)
+    {
+        mt_fill(&simulation->randomState, simulation->randomBatch, RANDOM_BATCH_COUNT);
+        simulation->randomBatchIndex = 0;
+    }
+    return simulation->randomBatch[simulation->randomBatchIndex++];
+}
+
+static void startCubeRows(CubeField *cubes, uint32_t startingIndex)
+{
+    cubes->xs[0] = 0.0f;
+    cubes->ys[0] = 0.0f;
+    cubes->zs[0] = 0.0f;
+    cubes->colorIndices[0] = 0;
+    cubes->flags[0] = 0;
+    
+    cubes->count = startingIndex;
+    cubes->nextRowDepth = startingIndex > 0 ? -CUBE_MAGNITUDE * 2 * 5 : 0.0f;
+}
+
+// Generates the next row of cubes without going past cubeLimit cubes in total
+static void generateCubeRow(Simulation *simulation, CubeField *cubes, uint32_t cubeLimit)
+{
+    uint32_t currentCubeIndex = cubes->count;
+    ZGFloat startDepth = cubes->nextRowDepth;
+    
+    const uint32_t maxCountPerExpertLevel = MAX_CUBE_COUNT_PER_LEVEL;
+    const uint32_t maxCountPerMediumLevel = 4;
+    const uint32_t maxCountPerBeginnerLevel = 3;
+    
+    const uint32_t cubeCountForMediumLevelEntry = 50;
+    const uint32_t cubeCountForExpertLevelEntry = 100;
+    
+    uint32_t prevRandomXIndices[MAX_CUBE_COUNT_PER_LEVEL] = {0};
+    const uint32_t maxDepthIncreaseCount = 5;
+    
+    const uint32_t maxCubesPerLevel = (uint32_t)((MAX_BOUNDARY_X_MAGNITUDE * 2.0f) / (CUBE_MAGNITUDE * 2.0f));
+    
+    uint32_t maxCountPerLevel;
+    if (currentCubeIndex < cubeCountForMediumLevelEntry)
+    {
+        maxCountPerLevel = maxCountPerBeginnerLevel;
+    }
+    else if (currentCubeIndex < cubeCountForExpertLevelEntry)
+    {
+        maxCountPerLevel = maxCountPerMediumLevel;
+    }
+    else
+    {
+        maxCountPerLevel = maxCountPerExpertLevel;
+    }
+    
+    uint32_t countPerLevel;
+    if (cubeLimit - currentCubeIndex < maxCountPerLevel)
+    {
+        countPerLevel = (nextRandom(simulation) % (cubeLimit - currentCubeIndex)) + 1;
+    }
+    else
+    {
+        countPerLevel = (nextRandom(simulation) % maxCountPerLevel) + 1;
+    }
+    
+    for (uint32_t cubeLevelIndex = 0; cubeLevelIndex < countPerLevel; cubeLevelIndex++)
+    {
+        uint32_t randomXIndex;
+        do
+        {
+            uint32_t randomNumber = nextRandom(simulation) % maxCubesPerLevel;
+            if (cubeLevelIndex == 0)
+            {
+                randomXIndex = randomNumber;
+                prevRandomXIndices[cubeLevelIndex] = randomXIndex;
+                break;
+            }
+            else
+            {
+                bool foundPrevRandomIndex = false;
+                for (uint32_t prevIndex = 0; prevIndex < cubeLevelIndex; prevIndex++)
+                {
+                    if (prevRandomXIndices[prevIndex] == randomNumber)
+                    {
+                        foundPrevRandomIndex = true;
+                        break;
+                    }
+                }
+                
+                if (!foundPrevRandomIndex)
+                {
+                    randomXIndex = randomNumber;
+                    prevRandomXIndices[cubeLevelIndex] = randomXIndex;
+                    break;
+                }
+            }
+        }
+        while (true);
+        
+        uint32_t storageIndex = currentCubeIndex & CUBE_INDEX_MASK;
+        cubes->xs[storageIndex] = (ZGFloat)(-MAX_BOUNDARY_X_MAGNITUDE + CUBE_MAGNITUDE) + (ZGFloat)randomXIndex * (CUBE_MAGNITUDE * 2);
+        cubes->ys[storageIndex] = 0.0f;
+        cubes->zs[storageIndex] = startDepth;
+        
+        cubes->colorIndices[storageIndex] = (uint8_t)(nextRandom(simulation) % CUBE_COLOR_COUNT);
+        cubes->flags[storageIndex] = 0;
+        // Storage is reused in endless mode, so never let a previous cube's cached warning path look current
+        cubes->warningPaths[storageIndex].warningGeneration = 0;
+        
+        currentCubeIndex++;
+    }
+    
+    uint32_t depthDecrease = nextRandom(simulation) % maxDepthIncreaseCount;
+    startDepth -= CUBE_MAGNITUDE * 2 * (2 + depthDecrease);
+    
+    cubes->count = currentCubeIndex;
+    cubes->nextRowDepth = startDepth;
+}
+
+static void generateCubePositions(Simulation *simulation, CubeField *cubes, uint32_t startingIndex)
+{
+    startCubeRows(cubes, startingIndex);
+    while (cubes->count < MAX_CUBE_COUNT)
+    {
+        generateCubeRow(simulation, cubes, MAX_CUBE_COUNT);
+    }
+}
+
+static void updateCubeWindow(Simulation *simulation)
+{
+    CubeField *cubes = &simulation->cubes;
+    
+    uint32_t cubeWindowStart = simulation->cubeWindowStart;
+    while (cubeWindowStart < cubes->count && (cubes->flags[cubeWindowStart & CUBE_INDEX_MASK] & CUBE_FLAG_DEAD) != 0)
+    {
+        cubeWindowStart++;
+    }
+    
+    ZGFloat farthestVisibleDepth = simulation->playerPosition.z - CUBE_PLAYER_DIST_AWAY;
+    
+    if (simulation->mode == SIMULATION_MODE_ENDLESS)
+    {
+        // Stream in rows until one lies past view distance, without overwriting cubes that may still be alive
+        while (cubes->zs[(cubes->count - 1) & CUBE_INDEX_MASK] >= farthestVisibleDepth && cubes->count + MAX_CUBE_COUNT_PER_LEVEL - cubeWindowStart <= MAX_CUBE_COUNT)
+        {
+            generateCubeRow(simulation, cubes, UINT32_MAX);
+        }
+    }
+    
+    // The player only moves forward, so the end of the window never moves back
+    uint32_t cubeWindowEnd = (simulation->cubeWindowEnd > cubeWindowStart) ? simulation->cubeWindowEnd : cubeWindowStart;
+    while (cubeWindowEnd < cubes->count && cubes->zs[cubeWindowEnd & CUBE_INDEX_MASK] >= farthestVisibleDepth)
+    {
+        cubeWindowEnd++;
+    }
+    
+    simulation->cubeWindowStart = cubeWindowStart;
+    simulation->cubeWindowEnd = cubeWindowEnd;
+}
+
+// Shifts the world forward so the player stays near the origin
+static void rebaseOrigin(Simulation *simulation, ZGFloat offset)
+{
+    simulation->playerPosition.z += offset;
+    simulation->previousPlayerPosition.z += offset;
+    
+    CubeField *cubes = &simulation->cubes;
+    for (uint32_t cubeIndex = simulation->cubeWindowStart; cubeIndex < cubes->count; cubeIndex++)
+    {
+        uint32_t storageIndex = cubeIndex & CUBE_INDEX_MASK;
+        cubes->zs[storageIndex] += offset;
+        cubes->warningPaths[storageIndex].enterDepth += offset;
+        cubes->warningPaths[storageIndex].exitDepth += offset;
+    }
+    cubes->nextRowDepth += offset;
+    
+    simulation->originRebaseCount++;
+}
+
+// Moves the player back to the start of the current field
+static void startCubeField(Simulation *simulation)
+{
+    simulation->warningGeneration++;
+    
+    simulation->playerPosition = vec3(0.0f, 0.0f, 20.0f);
+    simulation->previousPlayerPosition = simulation->playerPosition;
+    
+    simulation->cubeWindowStart = 0;
+    simulation->cubeWindowEnd = 0;
+    updateCubeWindow(simulation);
+}
+
+void generateSimulationNextField(Simulation *simulation)
+{
+    generateCubePositions(simulation, &simulation->nextCubes, 0);
+}
+
+// Returns true if a requested next field was waited on
+static bool finishNextFieldRequest(Simulation *simulation)
+{
+    if (!simulation->requestedNextField)
+    {
+        return false;
+    }
+    
+    simulation->fieldGenerator.waitForNextField(simulation, simulation->fieldGenerator.context);
+    simulation->requestedNextField = false;
+    return true;
+}
+
+static void swapInNextCubeField(Simulation *simulation)
+{
+    if (!finishNextFieldRequest(simulation))
+    {
+        generateSimulationNextField(simulation);
+    }
+    
+    CubeField previousCubes = simulation->cubes;
+    simulation->cubes = simulation->nextCubes;
+    simulation->nextCubes = previousCubes;
+    
+    startCubeField(simulation);
+}
+
+// Intersects the player's path with the collision sphere around the cube and caches the depths it enters and exits at
+// The player keeps moving along the same line until its direction changes, so this stays valid until then
+static void updateCubeWarningPath(CubeField *cubes, uint32_t cubeIndex, vec3_t playerPosition, vec3_t playerDirection, ZGFloat collisionDistance, uint32_t warningGeneration)
+{
+    vec3_t cubeToPlayer = v3_sub(playerPosition, vec3(cubes->xs[cubeIndex], cubes->ys[cubeIndex], cubes->zs[cubeIndex]));
+    ZGFloat halfB = v3_dot(cubeToPlayer, playerDirection);
+    ZGFloat c = v3_dot(cubeToPlayer, cubeToPlayer) - collisionDistance * collisionDistance;
+    ZGFloat discriminant = halfB * halfB - c;
+    
+    CubeWarningPath *warningPath = &cubes->warningPaths[cubeIndex];
+    warningPath->warningGeneration = warningGeneration;
+    if (discriminant >= 0.0f)
+    {
+        ZGFloat root = sqrtf(discriminant);
+        // The player moves towards decreasing depth, so the nearer root is the larger depth
+        warningPath->enterDepth = playerPosition.z + (-halfB - root) * playerDirection.z;
+        warningPath->exitDepth = playerPosition.z + (-halfB + root) * playerDirection.z;
+        cubes->flags[cubeIndex] |= CUBE_FLAG_WARNING_PATH_HITS;
+    }
+    else
+    {
+        cubes->flags[cubeIndex] &= ~CUBE_FLAG_WARNING_PATH_HITS;
+    }
+}
+
+// Checks if the cached collision depths fall within where the player will be over the warning window before it passes the cube
+// depthVelocity is the player's change in depth per second
+static bool cubeWarningPathCollides(const CubeField *cubes, uint32_t cubeIndex, ZGFloat playerDepth, ZGFloat depthVelocity)
+{
+    if ((cubes->flags[cubeIndex] & CUBE_FLAG_WARNING_PATH_HITS) == 0)
+    {
+        return false;
+    }
+    
+    ZGFloat nearestFutureDepth = playerDepth + (ZGFloat)CUBE_PLAYER_WARN_NEAREST_FUTURE_TIME * depthVelocity;
+    ZGFloat farthestFutureDepth = playerDepth + (ZGFloat)CUBE_PLAYER_WARN_FARTHEST_FUTURE_TIME * depthVelocity;
+    ZGFloat passedCubeDepth = cubes->zs[cubeIndex] + CUBE_MAGNITUDE + PLAYER_MAGNITUDE;
+    if (farthestFutureDepth < passedCubeDepth)
+    {
+        farthestFutureDepth = passedCubeDepth;
+    }
+    
+    const CubeWarningPath *warningPath = &cubes->warningPaths[cubeIndex];
+    return (warningPath->enterDepth >= farthestFutureDepth && warningPath->exitDepth <= nearestFutureDepth);
+}
+
+Simulation *createSimulation(SimulationMode mode, uint32_t seed)
+{
+    Simulation *simulation = calloc(1, sizeof(*simulation));
+    simulation->mode = mode;
+    
+    ZGFloat playerDiagonalDistance = sqrtf((PLAYER_MAGNITUDE * PLAYER_MAGNITUDE) + (PLAYER_MAGNITUDE * PLAYER_MAGNITUDE));
+    ZGFloat cubeDiagonalDistance = sqrtf((CUBE_MAGNITUDE * CUBE_MAGNITUDE) + (CUBE_MAGNITUDE * CUBE_MAGNITUDE));
+    simulation->playerCubeDiagonalSumDistance = playerDiagonalDistance + cubeDiagonalDistance;
+    
+    createCubeField(&simulation->cubes);
+    if (mode == SIMULATION_MODE_CLASSIC)
+    {
+        createCubeField(&simulation->nextCubes);
+    }
+    
+    seedSimulation(simulation, seed);
+    
+    return simulation;
+}
+
+void seedSimulation(Simulation *simulation, uint32_t seed)
+{
+    finishNextFieldRequest(simulation);
+    
+    mt_seed(&simulation->randomState, seed);
+    simulation->randomBatchIndex = RANDOM_BATCH_COUNT;
+    
+    simulation->playerSpeed = PLAYER_INITIAL_SPEED;
+    simulation->score = 0;
+    simulation->playerLost = false;
+    simulation->lastDeltaX = 0.0f;
+    
+    if (simulation->mode == SIMULATION_MODE_CLASSIC)
+    {
+        generateCubePositions(simulation, &simulation->cubes, 1);
+    }
+    else
+    {
+        // Rows are streamed in as the player advances
+        startCubeRows(&simulation->cubes, 1);
+    }
+    startCubeField(simulation);
+}
+
+void setSimulationFieldGenerator(Simulation *simulation, SimulationFieldGenerator fieldGenerator)
+{
+    finishNextFieldRequest(simulation);
+    simulation->fieldGenerator = fieldGenerator;
+}
+
+void destroySimulation(Simulation *simulation)
+{
+    finishNextFieldRequest(simulation);
+    
+    destroyCubeField(&simulation->cubes);
+    if (simulation->mode == SIMULATION_MODE_CLASSIC)
+    {
+        destroyCubeField(&simulation->nextCubes);
+    }
+    free(simulation);
+}
+
+SimulationObservation observeSimulation(const Simulation *simulation)
+{
+    SimulationObservation observation;
+    observation.playerPosition = simulation->playerPosition;
+    observation.previousPlayerPosition = simulation->previousPlayerPosition;
+    observation.playerSpeed = simulation->playerSpeed;
+    observation.score = simulation->score;
+    observation.playerLost = simulation->playerLost;
+    observation.cubeWindowStart = simulation->cubeWindowStart;
+    observation.cubeWindowEnd = simulation->cubeWindowEnd;
+    observation.cubeIndexMask = CUBE_INDEX_MASK;
+    observation.originRebaseCount = simulation->originRebaseCount;
+    observation.cubeXs = simulation->cubes.xs;
+    observation.cubeYs = simulation->cubes.ys;
+    observation.cubeZs = simulation->cubes.zs;
+    observation.cubeFlags = simulation->cubes.flags;
+    observation.cubeColorIndices = simulation->cubes.colorIndices;
+    return observation;
+}
+
+// Moves the player with input for timeDelta seconds and returns the direction moved in
+static vec3_t movePlayer(Simulation *simulation, SimulationInput input, double timeDelta)
+{
+    ZGFloat deltaX;
+    if (input.right && input.left)
+    {
+        deltaX = 0.0f;
+    }
+    else if (input.right && simulation->playerPosition.x + PLAYER_MAGNITUDE <= (ZGFloat)MAX_BOUNDARY_X_MAGNITUDE)
+    {
+        deltaX = 1.0f;
+    }
+    else if (input.left && simulation->playerPosition.x - PLAYER_MAGNITUDE >= (ZGFloat)(-MAX_BOUNDARY_X_MAGNITUDE))
+    {
+        deltaX = -1.0f;
+    }
+    else
+    {
+        deltaX = 0.0f;
+    }
+    
+    if (deltaX != simulation->lastDeltaX)
+    {
+        simulation->lastDeltaX = deltaX;
+        simulation->warningGeneration++;
+    }
+    
+    vec3_t playerDirection = v3_norm(vec3(deltaX, 0.0f, -1.0f));
+    vec3_t deltaVector = v3_muls(playerDirection, (ZGFloat)(timeDelta * simulation->playerSpeed));
+    simulation->playerPosition = v3_add(simulation->playerPosition, deltaVector);
+    
+    return playerDirection;
+}
+
+void stepSimulation(Simulation *simulation, SimulationInput input, double timeDelta)
+{
+    stepSimulationWithInputChanges(simulation, input, NULL, 0, timeDelta);
+}
+
+void stepSimulationWithInputChanges(Simulation *simulation, SimulationInput input, const SimulationInputChange *changes, uint32_t changeCount, double timeDelta)
+{
+    if (simulation->playerLost)
+    {
+        return;
+    }
+    
+    simulation->previousPlayerPosition = simulation->playerPosition;
+    
+    // Integrate the movement piecewise, switching input at each change
+    SimulationInput segmentInput = input;
+    double segmentStartFraction = 0.0;
+    for (uint32_t changeIndex = 0; changeIndex < changeCount; changeIndex++)
+    {
+        double changeFraction = changes[changeIndex].stepFraction;
+        if (changeFraction > segmentStartFraction)
+        {
+            movePlayer(simulation, segmentInput, (changeFraction - segmentStartFraction) * timeDelta);
+            segmentStartFraction = changeFraction;
+        }
+        segmentInput = changes[changeIndex].input;
+    }
+    vec3_t playerDirection = movePlayer(simulation, segmentInput, (1.0 - segmentStartFraction) * timeDelta);
+    
+    // Cubes passed below speed the player up, but warnings look ahead at the speed of this step
+    ZGFloat depthVelocity = playerDirection.z * simulation->playerSpeed;
+    
+    if (simulation->mode == SIMULATION_MODE_ENDLESS && simulation->playerPosition.z < -ORIGIN_REBASE_DISTANCE)
+    {
+        rebaseOrigin(simulation, ORIGIN_REBASE_DISTANCE);
+    }
+    
+    vec3_t playerPosition = simulation->playerPosition;
+    
+    updateCubeWindow(simulation);
+    
+    if (simulation->mode == SIMULATION_MODE_CLASSIC && simulation->cubeWindowStart >= simulation->cubes.count)
+    {
+        swapInNextCubeField(simulation);
+        return;
+    }
+    
+    if (simulation->mode == SIMULATION_MODE_CLASSIC && !simulation->requestedNextField && simulation->fieldGenerator.requestNextField != NULL && simulation->cubes.count - simulation->cubeWindowStart < NEXT_FIELD_REQUEST_THRESHOLD)
+    {
+        simulation->requestedNextField = true;
+        simulation->fieldGenerator.requestNextField(simulation, simulation->fieldGenerator.context);
+    }
+    
+    // Cubes past the end of the window are too far away to collide with or warn about
+    CubeField *cubes = &simulation->cubes;
+    uint32_t cubeWindowStart = simulation->cubeWindowStart;
+    uint32_t cubeWindowEnd = simulation->cubeWindowEnd;
+    
+    // Classify the whole window up front, then act on the results in order since losing stops any further cubes from being processed
+    // The window may wrap around the end of the storage, in which case it is classified in two parts
+    uint8_t *collisionResults = cubes->collisionResults;
+    ZGFloat collisionDistance = simulation->playerCubeDiagonalSumDistance;
+    ZGFloat warningDistance = collisionDistance * CUBE_PLAYER_WARN_MAX_FACTOR;
+    ZGFloat passedDepth = playerPosition.z - PLAYER_MAGNITUDE - CUBE_MAGNITUDE;
+    uint32_t storageWindowStart = cubeWindowStart & CUBE_INDEX_MASK;
+    uint32_t storageWindowEnd = storageWindowStart + (cubeWindowEnd - cubeWindowStart);
+    if (storageWindowEnd <= MAX_CUBE_COUNT)
+    {
+        classifyCubeCollisions(cubes->xs, cubes->ys, cubes->zs, storageWindowStart, storageWindowEnd, playerPosition.x, playerPosition.y, playerPosition.z, collisionDistance, warningDistance, passedDepth, collisionResults);
+    }
+    else
+    {
+        classifyCubeCollisions(cubes->xs, cubes->ys, cubes->zs, storageWindowStart, MAX_CUBE_COUNT, playerPosition.x, playerPosition.y, playerPosition.z, collisionDistance, warningDistance, passedDepth, collisionResults);
+        classifyCubeCollisions(cubes->xs, cubes->ys, cubes->zs, 0, storageWindowEnd - MAX_CUBE_COUNT, playerPosition.x, playerPosition.y, playerPosition.z, collisionDistance, warningDistance, passedDepth, collisionResults);
+    }
+    
+    for (uint32_t windowIndex = cubeWindowStart; windowIndex < cubeWindowEnd; windowIndex++)
+    {
+        uint32_t cubeIndex = windowIndex & CUBE_INDEX_MASK;
+        if ((cubes->flags[cubeIndex] & CUBE_FLAG_DEAD) != 0)
+        {
+            continue;
+        }
+        
+        uint8_t collisionResult = collisionResults[cubeIndex];
+        if ((collisionResult & CUBE_COLLISION_RESULT_HIT) != 0)
+        {
+            // Player loses here
+            simulation->playerLost = true;
+            break;
+        }
+        else if ((collisionResult & CUBE_COLLISION_RESULT_PASSED) != 0)
+        {
+            cubes->flags[cubeIndex] |= CUBE_FLAG_DEAD;
+            simulation->score++;
+            
+            if (simulation->playerSpeed < PLAYER_SPEED_CAP)
+            {
+                simulation->playerSpeed += PLAYER_SPEED_INCREASE;
+                if (simulation->playerSpeed > PLAYER_SPEED_CAP)
+                {
+                    simulation->playerSpeed = PLAYER_SPEED_CAP;
+                }
+            }
+        }
+        else if ((collisionResult & CUBE_COLLISION_RESULT_IN_WARNING_RANGE) != 0)
+        {
+            if (cubes->warningPaths[cubeIndex].warningGeneration != simulation->warningGeneration)
+            {
+                updateCubeWarningPath(cubes, cubeIndex, playerPosition, playerDirection, simulation->playerCubeDiagonalSumDistance, simulation->warningGeneration);
+            }
+            
+            if (cubeWarningPathCollides(cubes, cubeIndex, playerPosition.z, depthVelocity))
+            {
+                cubes->flags[cubeIndex] |= CUBE_FLAG_WARNING;
+            }
+            else
+            {
+                cubes->flags[cubeIndex] &= ~CUBE_FLAG_WARNING;
+            }
+        }
+        else
+        {
+            cubes->flags[cubeIndex] &= ~CUBE_FLAG_WARNING;
+        }
+    }
+}
+
+bool isSupportedSimulationTickRate(uint32_t tickRate)
+{
+    for (uint32_t supportedTickRate = SIMULATION_DEFAULT_TICK_RATE; supportedTickRate <= SIMULATION_MAX_TICK_RATE; supportedTickRate *= 2)
+    {
+        if (tickRate == supportedTickRate)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+double simulationTickInterval(uint32_t tickRate)
+{
+    // Divides SIMULATION_TICK_INTERVAL, which replays at the default rate were recorded with, instead of using 1 / tickRate
+    // Supported rates are power of two multiples of the default so the default rate gets exactly the same interval
+    return SIMULATION_TICK_INTERVAL / (double)(tickRate / SIMULATION_DEFAULT_TICK_RATE);
+}
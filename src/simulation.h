@@ -0,0 +1,140 @@
+/*
+ MIT License
+
+ Copyright (c) 2024 Mayur Pawashe
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#pragma once
+
+#include "math_3d.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Game logic that runs without a window, renderer or any other platform services
+
+// Steps per second. Physics is in per-second units so every supported rate plays the same, only more finely
+#define SIMULATION_DEFAULT_TICK_RATE 60
+#define SIMULATION_MAX_TICK_RATE 480
+#define SIMULATION_TICK_INTERVAL 0.01666 // in seconds, at SIMULATION_DEFAULT_TICK_RATE
+
+#define MAX_CUBE_COUNT 4096
+#define MAX_BOUNDARY_X_MAGNITUDE 8
+#define PLAYER_MAGNITUDE 0.05f
+#define CUBE_MAGNITUDE 1.0f
+
+#define CUBE_COLOR_COUNT 5
+
+#define CUBE_FLAG_DEAD 0x1
+#define CUBE_FLAG_WARNING 0x2
+
+typedef struct _Simulation Simulation;
+
+// Modes are stored in replays, so existing values must not change
+typedef enum
+{
+    // Fields of MAX_CUBE_COUNT cubes that start over from the beginning once every cube has been passed
+    SIMULATION_MODE_CLASSIC = 0,
+    // Rows of cubes are streamed in forever and the world is periodically shifted back towards the origin
+    SIMULATION_MODE_ENDLESS = 1
+} SimulationMode;
+
+typedef struct
+{
+    bool left;
+    bool right;
+} SimulationInput;
+
+// Input that takes effect partway through a step, at stepFraction in [0, 1] of the step's time
+typedef struct
+{
+    SimulationInput input;
+    double stepFraction;
+} SimulationInputChange;
+
+// Lets the next cube field be generated ahead of time, e.g. on a worker thread
+// requestNextField is called once few cubes are left alive and should arrange for generateSimulationNextField() to be called
+// waitForNextField is called when the next field is needed and must not return until that call has completed
+// Until then the simulation only steps through the current field, so generation can safely run concurrently with stepping
+// If requestNextField is NULL the next field is generated synchronously
+typedef struct
+{
+    void (*requestNextField)(Simulation *simulation, void *context);
+    void (*waitForNextField)(Simulation *simulation, void *context);
+    void *context;
+} SimulationFieldGenerator;
+
+// A read-only view into the simulation that stays valid until the next step or seed
+typedef struct
+{
+    vec3_t playerPosition;
+    // Where the player was before the latest step, for interpolating between steps
+    // Shifted along with the world when its origin is rebased, and equal to playerPosition after the player is moved to the start of a field
+    vec3_t previousPlayerPosition;
+    ZGFloat playerSpeed;
+    uint32_t score;
+    bool playerLost;
+    
+    // Cubes are stored in decreasing depth and only those in [cubeWindowStart, cubeWindowEnd) can be alive and within view distance
+    // Window indices must be masked with cubeIndexMask to index the cube arrays
+    uint32_t cubeWindowStart;
+    uint32_t cubeWindowEnd;
+    uint32_t cubeIndexMask;
+    
+    // Incremented whenever the world is shifted back towards the origin
+    uint32_t originRebaseCount;
+    
+    const ZGFloat *cubeXs;
+    const ZGFloat *cubeYs;
+    const ZGFloat *cubeZs;
+    const uint8_t *cubeFlags;
+    const uint8_t *cubeColorIndices;
+} SimulationObservation;
+
+// Creates a new game whose cubes are generated from seed
+// Simulations own their random number state, so the same seed and inputs always play out the same way
+Simulation *createSimulation(SimulationMode mode, uint32_t seed);
+
+// Restarts the game in the same mode with cubes generated from seed
+void seedSimulation(Simulation *simulation, uint32_t seed);
+
+// Advances the game by timeDelta seconds. Does nothing once the player has lost
+void stepSimulation(Simulation *simulation, SimulationInput input, double timeDelta);
+
+// Like stepSimulation() but input starts out as input and changes partway through the step, with changes in increasing stepFraction
+// The player moves with each input for its share of timeDelta, while cubes are checked against where the player ends up
+void stepSimulationWithInputChanges(Simulation *simulation, SimulationInput input, const SimulationInputChange *changes, uint32_t changeCount, double timeDelta);
+
+SimulationObservation observeSimulation(const Simulation *simulation);
+
+void destroySimulation(Simulation *simulation);
+
+void setSimulationFieldGenerator(Simulation *simulation, SimulationFieldGenerator fieldGenerator);
+
+// Supported tick rates are SIMULATION_DEFAULT_TICK_RATE doubled up to SIMULATION_MAX_TICK_RATE times, i.e. 60, 120, 240 and 480
+bool isSupportedSimulationTickRate(uint32_t tickRate);
+
+// The timeDelta to step with, in seconds, at a supported tick rate
+double simulationTickInterval(uint32_t tickRate);
+
+// Generates the field that is swapped in once every cube in the current one has been passed
+// Produces the same field whether it runs synchronously or ahead of time
+void generateSimulationNextField(Simulation *simulation);